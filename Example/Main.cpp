@@ -237,6 +237,31 @@ MTEST_TABLE_UNIT_TEST(MathTest, EnigmaticFunction, MathTestDataArray)
     CheckWork(testData.Arg1, testData.Arg2, testData.Result);
 }
 
+// Static name is generated without making fixture of row
+struct NamedTestTableFixture: public MTest::TableFixture<MathTestData, MTest::Fixture>
+{
+    static std::string GenerateRowName(const DataType& item, const std::size_t)
+    {
+        return item.Name;
+    }
+};
+MTEST_TABLE_UNIT_TEST(NamedTest, StaticName, MathTestDataArray)
+{
+    MTEST_CHECK_VALUE(testData.Arg1 + testData.Arg2, testData.Result);
+}
+
+// Rows are made from index only when test case runs
+const MTest::TableGenerator<MathTestData> MathTestGenerator{100uz, [](const std::size_t i)
+{
+    const int x = static_cast<int>(i);
+    return MathTestData{std::format("Add{}", x), x, -x, 0};
+}};
+
+MTEST_GENERATOR_UNIT_TEST(MathTest, GeneratedFunction, MathTestGenerator)
+{
+    CheckWork(testData.Arg1, testData.Arg2, testData.Result);
+}
+
 // User defined check
 
 // Define check function
@@ -312,7 +337,245 @@ MTEST_UNIT_TEST(User, SampleNear)
     MTEST_CHECK_NEAR(MyVector2(1.0f, 2.0f), MyVector2(5.0f, 5.0f), MTest::EPSILON_SMALL<float>);
 }
 
-// Implements main() function
+enum class Color
+{
+    Red,
+    Green,
+    Blue
+};
+
+// Compare ranges element by element, ranges must have random access and same size. Ranges of numbers, enums,
+// pointers and raw bytes are compared with SIMD instructions.
+MTEST_SIMPLE_UNIT_TEST(Ranges, Compare)
+{
+    std::vector<int> values{1, 2, 3, 4};
+    std::array<int, 4> wanted{1, 2, 3, 4};
+    MTEST_CHECK_RANGE_EQUAL(values, wanted);
+    std::vector<Color> colors{Color::Red, Color::Blue};
+    std::vector<Color> wantedColors{Color::Red, Color::Blue};
+    MTEST_CHECK_RANGE_EQUAL(colors, wantedColors);
+    std::vector<int*> pointers{&values[0], &values[1]};
+    std::vector<int*> wantedPointers{&values[0], &values[1]};
+    MTEST_CHECK_RANGE_EQUAL(pointers, wantedPointers);
+    std::vector<float> floats{1.0f, 2.0f, 3.0f};
+    std::vector<float> nearFloats{1.0f, 2.000001f, 3.0f};
+    // Absolute, relative and ULP tolerance.
+    MTEST_CHECK_RANGE_NEAR(floats, nearFloats, 1e-5f);
+    MTEST_CHECK_RANGE_NEAR(floats, nearFloats, MTest::Relative<float>{1e-6f});
+    MTEST_CHECK_RANGE_NEAR(floats, nearFloats, MTest::Ulps{16});
+    // Compare memory.
+    MTEST_ASSERT_BYTES_EQUAL(values.data(), wanted.data(), values.size() * sizeof(int));
+}
+
+MTEST_SIMPLE_UNIT_TEST(Ranges, CompareFail)
+{
+    std::vector<Color> colors{Color::Red, Color::Green, Color::Blue};
+    std::vector<Color> wantedColors{Color::Red, Color::Blue, Color::Blue};
+    MTEST_CHECK_RANGE_EQUAL(colors, wantedColors);
+    int a = 1;
+    int b = 2;
+    std::vector<int*> pointers{&a, &a};
+    std::vector<int*> wantedPointers{&a, &b};
+    MTEST_CHECK_RANGE_EQUAL(pointers, wantedPointers);
+    std::vector<double> doubles(64, 1.0);
+    std::vector<double> otherDoubles(64, 1.0);
+    otherDoubles[40] = 1.1;
+    MTEST_CHECK_RANGE_NEAR(doubles, otherDoubles, MTest::Relative<double>{0.01});
+    MTEST_CHECK_RANGE_NEAR(doubles, otherDoubles, MTest::Ulps{4});
+    MTEST_CHECK_BYTES_EQUAL(&a, &b, sizeof(int));
+    // Size must be same.
+    std::vector<Color> shorterColors{Color::Red};
+    MTEST_ASSERT_RANGE_EQUAL(colors, shorterColors);
+}
+
+// Failed check of multiline or long strings and of large ranges shows diff instead of whole values.
+MTEST_SIMPLE_UNIT_TEST(Diff, ShowDiff)
+{
+    std::string text{};
+    for(int i = 0; i < 40; ++i)
+    {
+        text += std::format("Line {}\n", i);
+    }
+    // Changed, inserted and removed lines.
+    std::string changed = text;
+    changed.replace(changed.find("Line 10"), 7, "Line ten");
+    changed.insert(changed.find("Line 20"), "New line\n");
+    changed.erase(changed.find("Line 30"), 8);
+    MTEST_CHECK_VALUE(text, changed);
+    // Only inserted or only removed lines.
+    MTEST_CHECK_VALUE(text, text + "Last line\n");
+    MTEST_CHECK_VALUE(text + "Last line\n", text);
+    // Single line strings are compared by characters.
+    std::string line(200, 'a');
+    std::string otherLine = line;
+    otherLine[100] = 'b';
+    MTEST_CHECK_VALUE(line, otherLine);
+    // Ranges are compared by elements.
+    std::vector<int> values(100);
+    std::iota(values.begin(), values.end(), 0);
+    std::vector<int> otherValues = values;
+    otherValues.erase(otherValues.begin() + 50);
+    MTEST_CHECK_VALUE(values, otherValues);
+    // Values which differ in too many places show only first difference.
+    MTEST_CHECK_VALUE(std::string(5000, 'a'), std::string(5000, 'b'));
+}
+
+// Benchmark, fixture name is inferred same way as in test case. Body must iterate over 'benchmark',
+// iterations count is chosen automatically.
+MTEST_SIMPLE_BENCHMARK(Benchmarks, VectorSum)
+{
+    std::vector<int> values(256, 1);
+    for(auto _: benchmark)
+    {
+        int sum = std::accumulate(values.begin(), values.end(), 0);
+        // Do not let compiler optimize away result.
+        MTest::DoNotOptimize(sum);
+    }
+}
+
+// Shared fixture is set up once for all test cases of section, MTEST_GLOBAL_FIXTURE shares it by all test cases.
+struct PrimeTableFixture: public MTest::SharedFixture
+{
+    void Setup() override
+    {
+        for(int i = 2; i < 100; ++i)
+        {
+            if( std::ranges::none_of(Primes, [&](const int p) { return i % p == 0; }) )
+            {
+                Primes.push_back(i);
+            }
+        }
+    }
+
+    void Cleanup() override
+    {
+        Primes.clear();
+    }
+
+    std::vector<int> Primes;
+};
+MTEST_SECTION_FIXTURE(Shared, PrimeTableFixture)
+
+MTEST_SIMPLE_UNIT_TEST(Shared, FirstPrimes)
+{
+    const auto& primes = MTest::GetSharedFixture<PrimeTableFixture>().Primes;
+    MTEST_ASSERT_VALUE(primes.size(), 25uz);
+    MTEST_CHECK_VALUE(primes.front(), 2);
+    MTEST_CHECK_VALUE(primes.back(), 97);
+}
+
+// Failed setup of shared fixture fails every test case which needs it.
+struct ServerConnectionFixture: public MTest::SharedFixture
+{
+    void Setup() override
+    {
+        throw std::runtime_error{"Server is not available"};
+    }
+};
+MTEST_SECTION_FIXTURE(SharedFail, ServerConnectionFixture)
+
+MTEST_SIMPLE_UNIT_TEST(SharedFail, Connect)
+{
+    MTEST_CHECK_TRUE(true);
+}
+
+// Time limit of test case, it overrides --timeout. Own spans of --trace-out timeline are added with MTEST_TRACE_SCOPE.
+struct TimeLimitFixture: public MTest::Fixture
+{
+    std::chrono::milliseconds Timeout() override
+    {
+        return std::chrono::milliseconds{2000};
+    }
+};
+
+MTEST_UNIT_TEST(TimeLimit, InTime)
+{
+    MTEST_TRACE_SCOPE("Sum");
+    std::vector<int> values(1000, 1);
+    MTEST_CHECK_VALUE(std::accumulate(values.begin(), values.end(), 0), 1000);
+}
+
+// Async test cases are coroutines, they run together on single event loop while they wait.
+struct AsyncFixture: public MTest::Fixture
+{
+    std::chrono::milliseconds Timeout() override
+    {
+        return std::chrono::milliseconds{200};
+    }
+};
+
+MTEST_ASYNC_UNIT_TEST(Async, Sleep)
+{
+    const auto start = std::chrono::steady_clock::now();
+    co_await MTest::SleepFor(std::chrono::milliseconds{20});
+    MTEST_CHECK_TRUE(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds{20});
+    // Let other async test cases run.
+    co_await MTest::Yield();
+}
+
+// Async test case over its time limit is cancelled, its pending operation throws and Cleanup is still called.
+MTEST_ASYNC_UNIT_TEST(Async, TimeoutFail)
+{
+    co_await MTest::SleepFor(std::chrono::seconds{10});
+    MTEST_FAIL("Not reached", false);
+}
+
+// Run body on several threads at once, limit is iteration count per thread or duration.
+MTEST_SIMPLE_UNIT_TEST(Concurrent, AtomicCounter)
+{
+    std::atomic<std::uint64_t> counter{0u};
+    const MTest::ConcurrentStats stats = MTEST_CONCURRENT(4, 10000u, [&](const std::size_t)
+    {
+        counter.fetch_add(1u, std::memory_order_relaxed);
+    });
+    MTEST_CHECK_VALUE(counter.load(), stats.Operations);
+}
+
+// Failed assertion in any thread stops all threads, failure is marked with index of thread.
+MTEST_SIMPLE_UNIT_TEST(Concurrent, ThreadFail)
+{
+    MTEST_CONCURRENT(2, 100u, [&](const std::size_t thread)
+    {
+        MTEST_ASSERT_VALUE(thread, 0uz);
+    });
+}
+
+// Explore interleavings of threads which use MTest::atomic and MTest::mutex, body is called once per schedule.
+MTEST_SIMPLE_UNIT_TEST(Explore, AtomicIncrement)
+{
+    MTEST_EXPLORE(MTest::ExploreOptions{.Schedules = 200}, [&](MTest::CInterleaving& schedule)
+    {
+        MTest::atomic<int> counter{0};
+        const auto increment = [&]() { counter.fetch_add(1); };
+        schedule.Run(increment, increment);
+        MTEST_CHECK_VALUE(counter.load(), 2);
+    });
+}
+
+// Separate load and store lose update in some schedule, its seed is printed so it can be replayed.
+MTEST_SIMPLE_UNIT_TEST(Explore, LostUpdateFail)
+{
+    MTEST_EXPLORE(MTest::ExploreOptions{.Strategy = MTest::EExploreStrategy::PCT}, [&](MTest::CInterleaving& schedule)
+    {
+        MTest::atomic<int> counter{0};
+        const auto increment = [&]() { counter.store(counter.load() + 1); };
+        schedule.Run(increment, increment);
+        MTEST_CHECK_VALUE(counter.load(), 2);
+    });
+}
+
+// Test cases are run with --changed-files when file they depend on is changed.
+MTEST_DEPENDS_ON(Shared, FirstPrimes, "Include/MTest.hpp")
+MTEST_SECTION_DEPENDS_ON(Ranges, "Include/MTest.hpp")
+
+// Implements main() function. Run is controlled by command line options, eg.:
+// --jobs=4 runs tests on 4 threads, with --isolate in worker processes so crash fails only its test case.
+// --shard-index=0 --shard-count=2 runs half of tests.
+// --junit-out=Report.xml --json-out=Report.jsonl --trace-out=Trace.json writes reports and timeline.
+// --timeout=1000 fails test case which runs longer than 1 second.
+// --repeat=10 --shuffle runs tests 10 times in random order.
+// --cache-dir=.mtest_cache --rerun-failed runs only tests which failed in previous run.
+// --changed-files=Include/MTest.hpp runs only tests affected by change.
 MTEST_MAIN
 
 // User can also implement own main function.
@@ -323,6 +586,9 @@ int main(int argc, char* argv[])
     MTest::GetLog().CreateSink<MTest::CConsoleSink>();
     // This will create file logger.
     MTest::GetLog().CreateSink<MTest::CFileSink>("Output.txt");
+    // This will create JUnit XML and JSON Lines reports.
+    MTest::GetLog().CreateSink<MTest::CJUnitSink>("Report.xml");
+    MTest::GetLog().CreateSink<MTest::CJsonLinesSink>("Report.jsonl");
     // Run tests.
 	return MTest::GetTestManager().Run(argc, argv) ? 0 : 1;
 }
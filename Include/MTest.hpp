@@ -23,9 +23,11 @@ SOFTWARE.
 */
 #pragma once
 #include <string>
+#include <string_view>
 #include <vector>
 #include <algorithm>
 #include <unordered_map>
+#include <unordered_set>
 #include <memory>
 #include <utility>
 #include <type_traits>
@@ -41,6 +43,27 @@ SOFTWARE.
 #include <format>
 #include <cmath>
 #include <limits>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <list>
+#include <functional>
+#include <charconv>
+#include <cstring>
+#include <bit>
+#include <exception>
+#include <ranges>
+#include <array>
+#include <random>
+#include <new>
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <coroutine>
+#include <latch>
+#include <semaphore>
 
 #if defined(_WIN64) || defined(_WIN32) || defined(WIN32)
     #define MTEST_WINDOWS_PLATFORM 1
@@ -50,11 +73,40 @@ SOFTWARE.
     #error "Unsupported platform"
 #endif
 
+#ifdef MTEST_LINUX_PLATFORM
+    #include <unistd.h>
+    #include <poll.h>
+    #include <signal.h>
+    #include <sys/wait.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <linux/perf_event.h>
+    #include <sys/epoll.h>
+    #include <sys/timerfd.h>
+    #include <pthread.h>
+    #include <sched.h>
+    #include <cerrno>
+#endif
+
 #if !defined(MTEST_CONFIG_NO_COLOR) && defined(MTEST_WINDOWS_PLATFORM)
     #define WIN32_LEAN_AND_MEAN
     #include <windows.h>
 #endif
 
+#if !defined(MTEST_CONFIG_NO_SIMD) && (defined(__x86_64__) || defined(_M_X64))
+    #define MTEST_X86_SIMD 1
+    #include <immintrin.h>
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+        #define MTEST_INTERNAL_TARGET_AVX2
+    #else
+        #define MTEST_INTERNAL_TARGET_AVX2 __attribute__((target("avx2")))
+    #endif
+#endif
+
 //// Utility
 
 #define MTEST_INTERNAL_MACRO_CONCAT(x, y) x##y
@@ -63,19 +115,26 @@ SOFTWARE.
 
 //// Assertions
 
-#define MTEST_INTERNAL_CHECK_TRUE(Condition, Type) MTest::GetTestManager().GetActiveTest()->CheckTrue( Condition, #Condition, Type )
-#define MTEST_INTERNAL_CHECK_FALSE(Condition, Type) MTest::GetTestManager().GetActiveTest()->CheckFalse( Condition, #Condition, Type )
-#define MTEST_INTERNAL_CHECK_VALUE(Value, Wanted, Type) MTest::GetTestManager().GetActiveTest()->CheckEqual( Value, Wanted, #Value, Type )
-#define MTEST_INTERNAL_CHECK_NOT_VALUE(Value, Wanted, Type) MTest::GetTestManager().GetActiveTest()->CheckNotEqual( Value, Wanted, #Value, Type )
-#define MTEST_INTERNAL_CHECK_POINTER(Value, Wanted, Type) MTest::GetTestManager().GetActiveTest()->CheckPointer( Value, Wanted, #Value, Type )
-#define MTEST_INTERNAL_CHECK_NOT_POINTER(Value, Wanted, Type) MTest::GetTestManager().GetActiveTest()->CheckNotPointer( Value, Wanted, #Value, Type )
-#define MTEST_INTERNAL_CHECK_NULL(Value, Type) MTest::GetTestManager().GetActiveTest()->CheckPointer( Value, nullptr, #Value, Type )
-#define MTEST_INTERNAL_CHECK_NOT_NULL(Value, Type) MTest::GetTestManager().GetActiveTest()->CheckNotPointer( Value, nullptr, #Value, Type )
-#define MTEST_INTERNAL_CHECK_NEAR(Value, Wanted, Epsilon, Type) MTest::GetTestManager().GetActiveTest()->CheckNear( Value, Wanted, Epsilon, #Value, Type )
-#define MTEST_INTERNAL_CHECK_THROW(Statement, Exception, Type) MTest::GetTestManager().GetActiveTest()->CheckThrow< Exception >( [&](){ Statement; }, #Statement, #Exception, Type )
-#define MTEST_INTERNAL_CHECK_ANY_THROW(Statement, Type) MTest::GetTestManager().GetActiveTest()->CheckAnyThrow( [&](){ Statement; }, #Statement, Type )
-#define MTEST_INTERNAL_CHECK_NO_THROW(Statement, Type) MTest::GetTestManager().GetActiveTest()->CheckNoThrow( [&](){ Statement; }, #Statement, Type )
-#define MTEST_INTERNAL_CHECK_CUSTOM(Result, Type) MTest::GetTestManager().GetActiveTest()->CheckCustom( Result, Type )
+/// Test case run by calling thread, it is plain thread local read so passing assertions stay cheap.
+#define MTEST_INTERNAL_ACTIVE_TEST MTest::Details::ActiveTest
+
+#define MTEST_INTERNAL_CHECK_TRUE(Condition, Type) MTEST_INTERNAL_ACTIVE_TEST->CheckTrue( Condition, #Condition, Type )
+#define MTEST_INTERNAL_CHECK_FALSE(Condition, Type) MTEST_INTERNAL_ACTIVE_TEST->CheckFalse( Condition, #Condition, Type )
+#define MTEST_INTERNAL_CHECK_VALUE(Value, Wanted, Type) MTEST_INTERNAL_ACTIVE_TEST->CheckEqual( Value, Wanted, #Value, Type )
+#define MTEST_INTERNAL_CHECK_NOT_VALUE(Value, Wanted, Type) MTEST_INTERNAL_ACTIVE_TEST->CheckNotEqual( Value, Wanted, #Value, Type )
+#define MTEST_INTERNAL_CHECK_POINTER(Value, Wanted, Type) MTEST_INTERNAL_ACTIVE_TEST->CheckPointer( Value, Wanted, #Value, Type )
+#define MTEST_INTERNAL_CHECK_NOT_POINTER(Value, Wanted, Type) MTEST_INTERNAL_ACTIVE_TEST->CheckNotPointer( Value, Wanted, #Value, Type )
+#define MTEST_INTERNAL_CHECK_NULL(Value, Type) MTEST_INTERNAL_ACTIVE_TEST->CheckPointer( Value, nullptr, #Value, Type )
+#define MTEST_INTERNAL_CHECK_NOT_NULL(Value, Type) MTEST_INTERNAL_ACTIVE_TEST->CheckNotPointer( Value, nullptr, #Value, Type )
+#define MTEST_INTERNAL_CHECK_NEAR(Value, Wanted, Epsilon, Type) MTEST_INTERNAL_ACTIVE_TEST->CheckNear( Value, Wanted, Epsilon, #Value, Type )
+#define MTEST_INTERNAL_CHECK_THROW(Statement, Exception, Type) MTEST_INTERNAL_ACTIVE_TEST->CheckThrow< Exception >( [&](){ Statement; }, #Statement, #Exception, Type )
+#define MTEST_INTERNAL_CHECK_ANY_THROW(Statement, Type) MTEST_INTERNAL_ACTIVE_TEST->CheckAnyThrow( [&](){ Statement; }, #Statement, Type )
+#define MTEST_INTERNAL_CHECK_NO_THROW(Statement, Type) MTEST_INTERNAL_ACTIVE_TEST->CheckNoThrow( [&](){ Statement; }, #Statement, Type )
+#define MTEST_INTERNAL_CHECK_CUSTOM(Result, Type) MTEST_INTERNAL_ACTIVE_TEST->CheckCustom( Result, Type )
+#define MTEST_INTERNAL_CHECK_MAX_ALLOCATIONS(Statement, Max, Type) MTEST_INTERNAL_ACTIVE_TEST->CheckMaxAllocations( [&](){ Statement; }, Max, #Statement, Type )
+#define MTEST_INTERNAL_CHECK_RANGE_EQUAL(Value, Wanted, Type) MTEST_INTERNAL_ACTIVE_TEST->CheckRangeEqual( Value, Wanted, #Value, Type )
+#define MTEST_INTERNAL_CHECK_RANGE_NEAR(Value, Wanted, Tolerance, Type) MTEST_INTERNAL_ACTIVE_TEST->CheckRangeNear( Value, Wanted, Tolerance, #Value, Type )
+#define MTEST_INTERNAL_CHECK_BYTES_EQUAL(Value, Wanted, Size, Type) MTEST_INTERNAL_ACTIVE_TEST->CheckBytesEqual( Value, Wanted, Size, #Value, Type )
 
 /// It must evaluate to true statement, if not test will fail and continue execution.
 #define MTEST_CHECK_TRUE(Condition) MTEST_INTERNAL_CHECK_TRUE(Condition, MTest::EFailType::Check)
@@ -103,6 +162,16 @@ SOFTWARE.
 #define MTEST_CHECK_NO_THROW(Statement) MTEST_INTERNAL_CHECK_NO_THROW(Statement, MTest::EFailType::Check)
 /// User defined check, if not evaluated to true statement test will fail and continue execution.
 #define MTEST_CHECK_CUSTOM(Result) MTEST_INTERNAL_CHECK_CUSTOM(Result, MTest::EFailType::Check)
+/// Check if statement performs at most given number of allocations, if not test will fail and continue execution. Requires MTEST_CONFIG_TRACK_ALLOCATIONS.
+#define MTEST_CHECK_MAX_ALLOCATIONS(Statement, Max) MTEST_INTERNAL_CHECK_MAX_ALLOCATIONS(Statement, Max, MTest::EFailType::Check)
+/// Check if statement does not allocate, if not test will fail and continue execution. Requires MTEST_CONFIG_TRACK_ALLOCATIONS.
+#define MTEST_CHECK_NO_ALLOCATIONS(Statement) MTEST_INTERNAL_CHECK_MAX_ALLOCATIONS(Statement, 0u, MTest::EFailType::Check)
+/// Check if ranges have same elements, if not test will fail and continue execution. First mismatch and count of mismatches are reported.
+#define MTEST_CHECK_RANGE_EQUAL(Value, Wanted) MTEST_INTERNAL_CHECK_RANGE_EQUAL(Value, Wanted, MTest::EFailType::Check)
+/// Check if elements of ranges are near, tolerance is epsilon, MTest::Relative or MTest::Ulps. If not test will fail and continue execution.
+#define MTEST_CHECK_RANGE_NEAR(Value, Wanted, Tolerance) MTEST_INTERNAL_CHECK_RANGE_NEAR(Value, Wanted, Tolerance, MTest::EFailType::Check)
+/// Check if memory blocks of given size have same bytes, if not test will fail and continue execution.
+#define MTEST_CHECK_BYTES_EQUAL(Value, Wanted, Size) MTEST_INTERNAL_CHECK_BYTES_EQUAL(Value, Wanted, Size, MTest::EFailType::Check)
 
 /// Must evaluate to true statement, if not test will fail and abort execution.
 #define MTEST_ASSERT_TRUE(Condition) MTEST_INTERNAL_CHECK_TRUE(Condition, MTest::EFailType::Assert)
@@ -130,20 +199,49 @@ SOFTWARE.
 #define MTEST_ASSERT_NO_THROW(Statement) MTEST_INTERNAL_CHECK_NO_THROW(Statement, MTest::EFailType::Assert)
 /// User defined assert, if not evaluated to true statement test will fail and abort execution.
 #define MTEST_ASSERT_CUSTOM(Result) MTEST_INTERNAL_CHECK_CUSTOM(Result, MTest::EFailType::Assert)
+/// Check if statement performs at most given number of allocations, if not test will fail and abort execution. Requires MTEST_CONFIG_TRACK_ALLOCATIONS.
+#define MTEST_ASSERT_MAX_ALLOCATIONS(Statement, Max) MTEST_INTERNAL_CHECK_MAX_ALLOCATIONS(Statement, Max, MTest::EFailType::Assert)
+/// Check if statement does not allocate, if not test will fail and abort execution. Requires MTEST_CONFIG_TRACK_ALLOCATIONS.
+#define MTEST_ASSERT_NO_ALLOCATIONS(Statement) MTEST_INTERNAL_CHECK_MAX_ALLOCATIONS(Statement, 0u, MTest::EFailType::Assert)
+/// Check if ranges have same elements, if not test will fail and abort execution. First mismatch and count of mismatches are reported.
+#define MTEST_ASSERT_RANGE_EQUAL(Value, Wanted) MTEST_INTERNAL_CHECK_RANGE_EQUAL(Value, Wanted, MTest::EFailType::Assert)
+/// Check if elements of ranges are near, tolerance is epsilon, MTest::Relative or MTest::Ulps. If not test will fail and abort execution.
+#define MTEST_ASSERT_RANGE_NEAR(Value, Wanted, Tolerance) MTEST_INTERNAL_CHECK_RANGE_NEAR(Value, Wanted, Tolerance, MTest::EFailType::Assert)
+/// Check if memory blocks of given size have same bytes, if not test will fail and abort execution.
+#define MTEST_ASSERT_BYTES_EQUAL(Value, Wanted, Size) MTEST_INTERNAL_CHECK_BYTES_EQUAL(Value, Wanted, Size, MTest::EFailType::Assert)
 
 //// Logs & Utility
 
 /// Fail test
-#define MTEST_FAIL(Reason, Stop) MTest::GetTestManager().GetActiveTest()->Fail( Reason, Stop )
+#define MTEST_FAIL(Reason, Stop) MTEST_INTERNAL_ACTIVE_TEST->Fail( Reason, Stop )
 
 /// Skip test
-#define MTEST_SKIP(Reason) MTest::GetTestManager().GetActiveTest()->Skip( Reason )
+#define MTEST_SKIP(Reason) MTEST_INTERNAL_ACTIVE_TEST->Skip( Reason )
 
 /// Print some information to stdout.
-#define MTEST_INFO(Msg) MTest::GetLog().Write( "[Message] {}\n", Msg )
+#define MTEST_INFO(Msg) MTest::Details::WriteInfo( Msg )
+
+/// Add span of enclosing scope to trace timeline written by --trace-out, it costs single check when trace is not written.
+#define MTEST_TRACE_SCOPE(Name) const MTest::Details::CTraceScope MTEST_MACRO_CONCAT(MTest_TraceScope_, __COUNTER__){Name, "user"}
+
+/// Run body on Threads threads started together, Limit is iteration count per thread or duration eg. 100ms. Body gets index of thread.
+/// Assertions in body are recorded by owning test case with index of thread, returns ConcurrentStats.
+#define MTEST_CONCURRENT(Threads, Limit, ...) MTest::RunConcurrent( Threads, Limit, __VA_ARGS__ )
+
+/// Explore interleavings of threads which use MTest::atomic and MTest::mutex: MTEST_EXPLORE(ExploreOptions, Body), body gets
+/// MTest::CInterleaving and runs threads of each schedule with its Run method. Returns ExploreStats.
+#define MTEST_EXPLORE(...) MTest::Explore( __VA_ARGS__ )
 
 //// Test Setup
 
+/// Test descriptor is constant initialized and only linked into registry during static init, tests are collected on first run.
+#define MTEST_INTERNAL_REGISTER(Section, Name, Descriptor, Collect) \
+namespace \
+{ \
+    constinit MTest::TestDescriptor Descriptor{#Section, #Name, std::source_location::current(), Collect}; \
+    const MTest::Registrar MTEST_MACRO_CONCAT(MTest_Registrar_, __COUNTER__){Descriptor}; \
+}
+
 #define MTEST_INTERNAL_TABLE_UNIT_TEST(Section, Name, DataArray, ParentFixture, ConcreteFixture) \
 struct ConcreteFixture final : ParentFixture, MTest::IFixtureWrapper \
 { \
@@ -152,35 +250,22 @@ struct ConcreteFixture final : ParentFixture, MTest::IFixtureWrapper \
     ConcreteFixture(const DataType& testData, const std::size_t testIndex): \
         MTest_TestData(testData), MTest_TestIndex(testIndex) \
     {} \
-    std::string MTest_GenerateName() { return ParentFixture::GenerateName(MTest_TestData, MTest_TestIndex); } \
+    static void MTest_Collect(const MTest::TestDescriptor& descriptor) \
+    { \
+        MTest::CollectTableTest<ConcreteFixture>(descriptor, DataArray); \
+    } \
+    std::string MTest_GenerateName() override { return MTest::Details::GenerateRowName<ConcreteFixture>(MTest_TestData, MTest_TestIndex, this); } \
     void MTest_Run(const DataType& testData); \
     void MTest_Run() override { MTest_Run(MTest_TestData); } \
     bool MTest_Skip() override { return ParentFixture::Skip(MTest_TestData); } \
     void MTest_Setup() override { ParentFixture::Setup(MTest_TestData); } \
     void MTest_Cleanup() override { ParentFixture::Cleanup(MTest_TestData); } \
+    std::chrono::milliseconds MTest_Timeout() override { return ParentFixture::Timeout(); } \
 private: \
-    const DataType MTest_TestData; \
+    const DataType& MTest_TestData; \
     const std::size_t MTest_TestIndex; \
 }; \
-namespace \
-{ \
-    const MTest::Registrar MTEST_MACRO_CONCAT(MTest_Registrar_, __COUNTER__) \
-    { \
-        []() \
-        { \
-            const auto numCases = DataArray.size(); \
-            for(std::size_t i{0uz}; i < numCases; ++i) \
-            { \
-                auto fixture = std::make_unique<ConcreteFixture>(DataArray[i], i); \
-                const std::string caseName = std::format("{}[{}]", #Name, fixture->MTest_GenerateName()); \
-                MTest::GetTestManager().AddTest \
-                ( \
-                    #Section, caseName, std::source_location::current(), std::move(fixture) \
-                ); \
-            } \
-        } \
-    }; \
-} \
+MTEST_INTERNAL_REGISTER(Section, Name, MTEST_MACRO_CONCAT(ConcreteFixture, _Descriptor), &ConcreteFixture::MTest_Collect) \
 void ConcreteFixture::MTest_Run([[maybe_unused]] const ConcreteFixture::DataType& testData)
 
 /// Define test case: give section name, test case name, data array and fixture name.
@@ -192,6 +277,41 @@ void ConcreteFixture::MTest_Run([[maybe_unused]] const ConcreteFixture::DataType
 /// Test case name must be unique in given section.
 #define MTEST_TABLE_UNIT_TEST(Section, Name, DataArray) MTEST_TABLE_UNIT_TEST_FIXTURE(Section, Name, DataArray, Section##TableFixture )
 
+#define MTEST_INTERNAL_GENERATOR_UNIT_TEST(Section, Name, Generator, ParentFixture, ConcreteFixture) \
+struct ConcreteFixture final : ParentFixture, MTest::IFixtureWrapper \
+{ \
+    static_assert(MTest::IsTableGenerator<decltype(Generator)>, "Generator must have size() and operator[]"); \
+    static_assert(MTest::IsTableFixture<ParentFixture>, "Must be base of TableFixture"); \
+    ConcreteFixture(DataType testData, const std::size_t testIndex): \
+        MTest_TestData(std::move(testData)), MTest_TestIndex(testIndex) \
+    {} \
+    static void MTest_Collect(const MTest::TestDescriptor& descriptor) \
+    { \
+        MTest::CollectGeneratorTest<ConcreteFixture>(descriptor, Generator); \
+    } \
+    std::string MTest_GenerateName() override { return MTest::Details::GenerateRowName<ConcreteFixture>(MTest_TestData, MTest_TestIndex, this); } \
+    void MTest_Run(const DataType& testData); \
+    void MTest_Run() override { MTest_Run(MTest_TestData); } \
+    bool MTest_Skip() override { return ParentFixture::Skip(MTest_TestData); } \
+    void MTest_Setup() override { ParentFixture::Setup(MTest_TestData); } \
+    void MTest_Cleanup() override { ParentFixture::Cleanup(MTest_TestData); } \
+    std::chrono::milliseconds MTest_Timeout() override { return ParentFixture::Timeout(); } \
+private: \
+    const DataType MTest_TestData; \
+    const std::size_t MTest_TestIndex; \
+}; \
+MTEST_INTERNAL_REGISTER(Section, Name, MTEST_MACRO_CONCAT(ConcreteFixture, _Descriptor), &ConcreteFixture::MTest_Collect) \
+void ConcreteFixture::MTest_Run([[maybe_unused]] const ConcreteFixture::DataType& testData)
+
+/// Define test case: give section name, test case name, generator and fixture name. Each row is test case 'Name[Index]',
+/// row is made only when its test case runs. Fixture must be derived from MTest::TableFixture.
+#define MTEST_GENERATOR_UNIT_TEST_FIXTURE(Section, Name, Generator, ParentFixture) \
+    MTEST_INTERNAL_GENERATOR_UNIT_TEST(Section, Name, Generator, ParentFixture, MTEST_MACRO_CONCAT(MTest_##ParentFixture, __COUNTER__))
+
+/// Define test case: give section name, test case name and generator. Fixture name is inferred from section name eg. 'Section' + TableFixture.
+/// Each row is test case 'Name[Index]', row is made only when its test case runs.
+#define MTEST_GENERATOR_UNIT_TEST(Section, Name, Generator) MTEST_GENERATOR_UNIT_TEST_FIXTURE(Section, Name, Generator, Section##TableFixture )
+
 #define MTEST_INTERNAL_UNIT_TEST(Section, Name, ParentFixture, ConcreteFixture) \
 struct ConcreteFixture final : ParentFixture, MTest::IFixtureWrapper \
 { \
@@ -200,20 +320,9 @@ struct ConcreteFixture final : ParentFixture, MTest::IFixtureWrapper \
     bool MTest_Skip() override { return ParentFixture::Skip(); } \
     void MTest_Setup() override { ParentFixture::Setup(); } \
     void MTest_Cleanup() override { ParentFixture::Cleanup(); } \
+    std::chrono::milliseconds MTest_Timeout() override { return ParentFixture::Timeout(); } \
 }; \
-namespace \
-{ \
-    const MTest::Registrar MTEST_MACRO_CONCAT(MTest_Registrar_, __COUNTER__) \
-    { \
-        []() \
-        { \
-            MTest::GetTestManager().AddTest \
-            ( \
-                #Section, #Name, std::source_location::current(), std::make_unique<ConcreteFixture>() \
-            ); \
-        } \
-    }; \
-} \
+MTEST_INTERNAL_REGISTER(Section, Name, MTEST_MACRO_CONCAT(ConcreteFixture, _Descriptor), &MTest::CollectTest<ConcreteFixture>) \
 void ConcreteFixture::MTest_Run()
 
 /// Define test case: give section name, test case name and fixture name.
@@ -228,6 +337,91 @@ void ConcreteFixture::MTest_Run()
 /// Test case name must be unique in given section.
 #define MTEST_SIMPLE_UNIT_TEST(Section, Name) MTEST_INTERNAL_UNIT_TEST(Section, Name, MTest::Fixture, MTEST_MACRO_CONCAT(MTest_Fixture, __COUNTER__))
 
+#define MTEST_INTERNAL_BENCHMARK(Section, Name, ParentFixture, ConcreteFixture) \
+struct ConcreteFixture final : ParentFixture, MTest::IFixtureWrapper \
+{ \
+    static_assert(std::derived_from<ParentFixture, MTest::Fixture>, "Must be base of Fixture"); \
+    void MTest_Benchmark(MTest::CBenchmark& benchmark); \
+    void MTest_Run() override { MTest::RunBenchmark([this](MTest::CBenchmark& benchmark) { MTest_Benchmark(benchmark); }); } \
+    bool MTest_Skip() override { return ParentFixture::Skip(); } \
+    void MTest_Setup() override { ParentFixture::Setup(); } \
+    void MTest_Cleanup() override { ParentFixture::Cleanup(); } \
+    std::chrono::milliseconds MTest_Timeout() override { return ParentFixture::Timeout(); } \
+}; \
+MTEST_INTERNAL_REGISTER(Section, Name, MTEST_MACRO_CONCAT(ConcreteFixture, _Descriptor), &MTest::CollectTest<ConcreteFixture>) \
+void ConcreteFixture::MTest_Benchmark([[maybe_unused]] MTest::CBenchmark& benchmark)
+
+/// Define benchmark: give section name, benchmark name and fixture name. Body must iterate over 'benchmark'.
+/// Benchmark name must be unique in given section.
+#define MTEST_BENCHMARK_FIXTURE(Section, Name, ParentFixture) MTEST_INTERNAL_BENCHMARK(Section, Name, ParentFixture, MTEST_MACRO_CONCAT(MTest_##ParentFixture, __COUNTER__))
+
+/// Define benchmark: give section name and benchmark name. Fixture name is inferred from section name eg. 'Section' + Fixture.
+/// Body must iterate over 'benchmark'. Benchmark name must be unique in given section.
+#define MTEST_BENCHMARK(Section, Name) MTEST_BENCHMARK_FIXTURE(Section, Name, Section##Fixture )
+
+/// Define benchmark: give section name and benchmark name. It does not require fixture - it will use default fixture.
+/// Body must iterate over 'benchmark'. Benchmark name must be unique in given section.
+#define MTEST_SIMPLE_BENCHMARK(Section, Name) MTEST_INTERNAL_BENCHMARK(Section, Name, MTest::Fixture, MTEST_MACRO_CONCAT(MTest_Fixture, __COUNTER__))
+
+#define MTEST_INTERNAL_ASYNC_UNIT_TEST(Section, Name, ParentFixture, ConcreteFixture) \
+struct ConcreteFixture final : ParentFixture, MTest::IFixtureWrapper \
+{ \
+    static_assert(std::derived_from<ParentFixture, MTest::Fixture>, "Must be base of Fixture"); \
+    MTest::Task MTest_RunAsync() override; \
+    void MTest_Run() override { MTest::Details::RunTask(MTest_RunAsync()); } \
+    bool MTest_Skip() override { return ParentFixture::Skip(); } \
+    void MTest_Setup() override { ParentFixture::Setup(); } \
+    void MTest_Cleanup() override { ParentFixture::Cleanup(); } \
+    std::chrono::milliseconds MTest_Timeout() override { return ParentFixture::Timeout(); } \
+}; \
+MTEST_INTERNAL_REGISTER(Section, Name, MTEST_MACRO_CONCAT(ConcreteFixture, _Descriptor), &MTest::CollectAsyncTest<ConcreteFixture>) \
+MTest::Task ConcreteFixture::MTest_RunAsync()
+
+/// Define async test case: give section name, test case name and fixture name. Body is coroutine, it must use co_await or co_return.
+/// Async test cases are run together on single event loop, so they overlap while they wait. Test case name must be unique in given section.
+#define MTEST_ASYNC_UNIT_TEST_FIXTURE(Section, Name, ParentFixture) \
+    MTEST_INTERNAL_ASYNC_UNIT_TEST(Section, Name, ParentFixture, MTEST_MACRO_CONCAT(MTest_##ParentFixture, __COUNTER__))
+
+/// Define async test case: give section name and test case name. Fixture name is inferred from section name eg. 'Section' + Fixture.
+/// Body is coroutine, it must use co_await or co_return.
+#define MTEST_ASYNC_UNIT_TEST(Section, Name) MTEST_ASYNC_UNIT_TEST_FIXTURE(Section, Name, Section##Fixture )
+
+/// Define async test case: give section name and test case name. It does not require fixture - it will use default fixture.
+/// Body is coroutine, it must use co_await or co_return.
+#define MTEST_SIMPLE_ASYNC_UNIT_TEST(Section, Name) MTEST_INTERNAL_ASYNC_UNIT_TEST(Section, Name, MTest::Fixture, MTEST_MACRO_CONCAT(MTest_Fixture, __COUNTER__))
+
+#define MTEST_INTERNAL_SHARED_FIXTURE(SectionName, Fixture, Descriptor) \
+namespace \
+{ \
+    constinit MTest::SharedFixtureDescriptor Descriptor{SectionName, #Fixture, []() -> std::unique_ptr<MTest::SharedFixture> { return std::make_unique<Fixture>(); }}; \
+    const MTest::Registrar MTEST_MACRO_CONCAT(MTest_Registrar_, __COUNTER__){Descriptor}; \
+}
+
+/// Define fixture shared by all test cases of section: give section name and fixture derived from MTest::SharedFixture.
+/// It is set up once per worker before first test case of section, access it with MTest::GetSharedFixture<Fixture>().
+#define MTEST_SECTION_FIXTURE(Section, Fixture) MTEST_INTERNAL_SHARED_FIXTURE(#Section, Fixture, MTEST_MACRO_CONCAT(MTest_SharedFixture_, __COUNTER__))
+
+/// Define fixture shared by all test cases: give fixture derived from MTest::SharedFixture.
+/// It is set up once per worker before first test case, access it with MTest::GetSharedFixture<Fixture>().
+#define MTEST_GLOBAL_FIXTURE(Fixture) MTEST_INTERNAL_SHARED_FIXTURE(nullptr, Fixture, MTEST_MACRO_CONCAT(MTest_SharedFixture_, __COUNTER__))
+
+#define MTEST_INTERNAL_DEPENDS_ON(SectionName, TestName, Descriptor, Files, ...) \
+namespace \
+{ \
+    constexpr const char* Files[]{__VA_ARGS__}; \
+    constinit MTest::DependencyDescriptor Descriptor{SectionName, TestName, Files, std::size(Files)}; \
+    const MTest::Registrar MTEST_MACRO_CONCAT(MTest_Registrar_, __COUNTER__){Descriptor}; \
+}
+
+/// Declare source files which test case depends on besides file in which it is defined: give section name, test case name and paths.
+/// Test case is then selected by --changed-files when any of them is changed. Paths are matched by trailing components eg. "Source/Math.cpp".
+#define MTEST_DEPENDS_ON(Section, Name, ...) MTEST_INTERNAL_DEPENDS_ON(#Section, #Name, MTEST_MACRO_CONCAT(MTest_Dependency_, __COUNTER__), \
+    MTEST_MACRO_CONCAT(MTest_DependencyFiles_, __COUNTER__), __VA_ARGS__)
+
+/// Declare source files which all test cases of section depend on: give section name and paths.
+#define MTEST_SECTION_DEPENDS_ON(Section, ...) MTEST_INTERNAL_DEPENDS_ON(#Section, nullptr, MTEST_MACRO_CONCAT(MTest_Dependency_, __COUNTER__), \
+    MTEST_MACRO_CONCAT(MTest_DependencyFiles_, __COUNTER__), __VA_ARGS__)
+
 /// Add console sink.
 #define MTEST_CREATE_CONSOLE_SINK MTest::GetLog().CreateSink<MTest::CConsoleSink>()
 /// Add file sink.
@@ -235,8 +429,38 @@ void ConcreteFixture::MTest_Run()
 /// Use to launch unit test application.
 #define MTEST_RUN_TESTS(...) MTest::GetTestManager().Run( __VA_ARGS__ )
 
+#ifdef MTEST_CONFIG_TRACK_ALLOCATIONS
+/// Replaced global allocation functions, other forms of operator new and delete forward to them. MTEST_MAIN uses it,
+/// with own main() use it once at global scope of one file.
+#define MTEST_ALLOCATION_TRACKER \
+[[maybe_unused]] static const bool MTestAllocationTrackerInstalled = MTest::Details::InstallAllocationTracker(); \
+void* operator new(std::size_t size) \
+{ \
+    if( void* ptr = MTest::Details::TrackedAllocate(size, 0uz) ) \
+    { \
+        return ptr; \
+    } \
+    throw std::bad_alloc{}; \
+} \
+void* operator new(std::size_t size, std::align_val_t alignment) \
+{ \
+    if( void* ptr = MTest::Details::TrackedAllocate(size, static_cast<std::size_t>(alignment)) ) \
+    { \
+        return ptr; \
+    } \
+    throw std::bad_alloc{}; \
+} \
+void operator delete(void* ptr) noexcept { MTest::Details::TrackedFree(ptr, 0uz); } \
+void operator delete(void* ptr, std::align_val_t alignment) noexcept { MTest::Details::TrackedFree(ptr, static_cast<std::size_t>(alignment)); } \
+void operator delete(void* ptr, std::size_t) noexcept { MTest::Details::TrackedFree(ptr, 0uz); } \
+void operator delete(void* ptr, std::size_t, std::align_val_t alignment) noexcept { MTest::Details::TrackedFree(ptr, static_cast<std::size_t>(alignment)); }
+#else
+#define MTEST_ALLOCATION_TRACKER
+#endif
+
 /// Use to Implement Unit test main().
 #define MTEST_MAIN \
+MTEST_ALLOCATION_TRACKER \
 int main(int argc, char* argv[]) \
 { \
     MTEST_CREATE_CONSOLE_SINK; \
@@ -264,6 +488,10 @@ namespace MTest
         Magenta
     };
 
+    class CTestCase;
+    struct TestFailure;
+    struct RunSummary;
+
     class ISink
     {
     public:
@@ -277,6 +505,20 @@ namespace MTest
 
         virtual void SetColor(const EConsoleColor) = 0;
         virtual void Write(const std::string&) = 0;
+        /// Push buffered data to its destination.
+        virtual void Flush() {}
+
+        /// Structured events, they are reported in test order after each test case has finished.
+        /// OnTestReport begins report of finished test case, it is followed by its failures and OnTestEnd.
+        virtual void OnRunStart() {}
+        virtual void OnSectionStart(const std::string&) {}
+        virtual void OnTestReport(const CTestCase&) {}
+        virtual void OnTestFailure(const CTestCase&, const TestFailure&) {}
+        virtual void OnTestEnd(const CTestCase&) {}
+        virtual void OnSectionEnd(const std::string&) {}
+        virtual void OnRunEnd(const RunSummary&) {}
+        /// Run is ended by watchdog without OnRunEnd, process exits right after so report must be completed here.
+        virtual void OnRunAbort(const std::string&) {}
     };
 
     class CConsoleSink final: public ISink
@@ -347,7 +589,8 @@ namespace MTest
         void SetColor(const EConsoleColor) override {}
     #endif
 
-        void Write(const std::string& msg) override { std::fputs(msg.c_str(), stdout); }
+        void Write(const std::string& msg) override { std::fwrite(msg.data(), 1uz, msg.size(), stdout); }
+        void Flush() override { std::fflush(stdout); }
     
     #if !defined(MTEST_CONFIG_NO_COLOR) && defined(MTEST_WINDOWS_PLATFORM)
     private:
@@ -400,793 +643,7998 @@ namespace MTest
         {
             if( Handle )
             {
-                std::fputs(x.c_str(), Handle);
+                std::fwrite(x.data(), 1uz, x.size(), Handle);
+            }
+        }
+
+        void Flush() override
+        {
+            if( Handle )
+            {
+                std::fflush(Handle);
             }
         }
     private:
         std::FILE* Handle{};
     };
 
-    class CLog final
+    /// One piece of buffered log output.
+    struct LogRecord
     {
-    private:
-        CLog() = default;
-    public:
-        CLog(const CLog&) = delete;
-        CLog(CLog&&) = delete;
-        ~CLog() = default;
+        EConsoleColor Color{EConsoleColor::Default};
+        bool HasColor{false};
+        std::string Text{};
+    };
 
-        CLog& operator=(const CLog&) = delete;
-        CLog& operator=(CLog&&) = delete;
+    /// Log output of one test case, kept until it can be written to sinks in order.
+    using LogBuffer = std::vector<LogRecord>;
 
-        static CLog& Instance()
-        {
-            static CLog log;
-            return log;
-        }
+    /// Allocations made by test case, present only when MTEST_CONFIG_TRACK_ALLOCATIONS is defined.
+    struct AllocationStats
+    {
+        std::uint64_t Count{0u};
+        std::uint64_t Bytes{0u};
+        std::uint64_t Peak{0u}; // Live bytes
+        std::uint64_t Leaked{0u}; // Bytes still live after Cleanup
+        std::uint64_t LeakedCount{0u};
+    };
 
-        // Create sink for test output
-        template<std::derived_from<ISink> T, class...Args>
-        void CreateSink(Args&&...args)
-        {
-            Sinks.emplace_back(std::make_unique<T>(std::forward<Args>(args)...));
-        }
+    namespace Details
+    {
+    #ifdef MTEST_CONFIG_TRACK_ALLOCATIONS
+        constexpr bool TrackAllocations = true;
+    #else
+        constexpr bool TrackAllocations = false;
+    #endif
 
-        template<class...Args>
-        void Write(const EConsoleColor textColor, const std::format_string<Args...> fmt, Args&&...args)
+        /// Allocation counters of current thread, updated by replaced operator new and delete.
+        struct AllocationCounters
         {
-            Write(textColor, std::format(fmt, std::forward<Args>(args)...));
-        }
+            std::uint64_t Count{0u};
+            std::uint64_t Bytes{0u};
+            std::int64_t Live{0}; // Can be negative if memory is freed on other thread
+            std::int64_t LiveCount{0};
+            std::int64_t Peak{0};
+            std::uint32_t Paused{0u};
+        };
+        constinit inline thread_local AllocationCounters Allocations{};
 
-        void Write(const EConsoleColor textColor, const std::string& string)
+        /// Set before main by MTEST_ALLOCATION_TRACKER, without it allocations are never counted.
+        constinit inline bool AllocationTrackerInstalled{false};
+
+        inline bool InstallAllocationTracker()
         {
-            SetColor(textColor);
-            Write(string);
-            SetColor(EConsoleColor::Default);
+            AllocationTrackerInstalled = true;
+            return true;
         }
 
-        template<class...Args>
-        void Write(const std::format_string<Args...> fmt, Args&&...args)
+        /// Stored before each tracked block.
+        struct alignas(16) AllocationHeader
         {
-            Write(std::format(fmt, std::forward<Args>(args)...));
-        }
+            std::size_t Size{};
+            bool Tracked{};
+        };
 
-        void Write(const std::string& string)
+        inline void* TrackedAllocate(const std::size_t size, const std::size_t alignment) noexcept
         {
-            for(const auto& i: Sinks)
+            const std::size_t offset = std::max(alignment, sizeof(AllocationHeader));
+        #ifdef MTEST_WINDOWS_PLATFORM
+            void* base = _aligned_malloc(size + offset, std::max(alignment, alignof(AllocationHeader)));
+        #else
+            void* base = alignment > alignof(AllocationHeader) ?
+                std::aligned_alloc(alignment, (size + offset + alignment - 1uz) / alignment * alignment) : std::malloc(size + offset);
+        #endif
+            if( !base )
             {
-                i->Write(string);
+                return nullptr;
+            }
+            auto* block = static_cast<std::byte*>(base) + offset;
+            auto* header = reinterpret_cast<AllocationHeader*>(block) - 1;
+            header->Size = size;
+            header->Tracked = Allocations.Paused == 0u;
+            if( header->Tracked )
+            {
+                ++Allocations.Count;
+                Allocations.Bytes += size;
+                Allocations.Live += static_cast<std::int64_t>(size);
+                ++Allocations.LiveCount;
+                Allocations.Peak = std::max(Allocations.Peak, Allocations.Live);
             }
+            return block;
         }
-    private:
-        void SetColor(const EConsoleColor textColor)
+
+        inline void TrackedFree(void* ptr, const std::size_t alignment) noexcept
         {
-            for(const auto& i: Sinks)
+            if( !ptr )
             {
-                i->SetColor(textColor);
+                return;
+            }
+            const auto* header = static_cast<AllocationHeader*>(ptr) - 1;
+            if( header->Tracked )
+            {
+                Allocations.Live -= static_cast<std::int64_t>(header->Size);
+                --Allocations.LiveCount;
             }
+            void* base = static_cast<std::byte*>(ptr) - std::max(alignment, sizeof(AllocationHeader));
+        #ifdef MTEST_WINDOWS_PLATFORM
+            _aligned_free(base);
+        #else
+            std::free(base);
+        #endif
         }
-    private:
-        std::vector<std::unique_ptr<ISink>> Sinks{};
-    };
-    inline CLog& GetLog() { return CLog::Instance(); }
-
-    /// Can be used to init some data before each test. Test function has access to its internals (excluding private) - prefer structs (public default access).
-    struct Fixture
-    {
-        Fixture() = default;
-        Fixture(const Fixture&) = delete;
-        Fixture(Fixture&&) = delete;
-        virtual ~Fixture() = default;
-        
-        Fixture& operator=(const Fixture&) = delete;
-        Fixture& operator=(Fixture&&) = delete;
-
-        /// Should return true if test case should be skipped.
-        virtual bool Skip() { return false; }
-        /// Use Assertions to check state.
-        virtual void Setup() {}
-        /// Cleanup if needed.
-        virtual void Cleanup() {}
-    };
 
-    /// Table test data array
-    template<class T>
-    using TableDataArray = std::vector<T>;
+        /// Allocations made by framework itself, eg. buffered output, are not counted while it exists.
+        /// Lazily created framework state, eg. thread_local buffers of worker, must be allocated under it, otherwise
+        /// the first test case which touches it would report it as leak.
+        class CAllocationPause final
+        {
+        public:
+            CAllocationPause() noexcept { ++Allocations.Paused; }
+            CAllocationPause(const CAllocationPause&) = delete;
+            CAllocationPause(CAllocationPause&&) = delete;
+            ~CAllocationPause() { --Allocations.Paused; }
 
-    template<class T>
-    concept IsTableDataArray = 
-        requires { typename T::value_type; } &&
-        std::same_as<T, std::vector<typename T::value_type>>;
+            CAllocationPause& operator=(const CAllocationPause&) = delete;
+            CAllocationPause& operator=(CAllocationPause&&) = delete;
+        };
+    }
 
-    /// Fixture to use with Table tests.
-    template<class Type, std::derived_from<Fixture> Base>
-    struct TableFixture: Base
+    /// Performance counters of current thread, collected with --perf-counters. Counter is missing if it is not available.
+    struct PerfCounterStats
     {
-        using DataType = Type;
-        using BaseClass = Base;
-
-        TableFixture() = default;
-        virtual ~TableFixture() = default;
-
-        /// Get Test case name
-        virtual std::string GenerateName(const DataType&, const std::size_t i) { return std::to_string(i); }
-
-        /// Should return true if test case should be skipped.
-        virtual bool Skip(const DataType&) { return BaseClass::Skip(); }
-        using BaseClass::Skip;
-
-        /// Use Assertions to check state.
-        virtual void Setup(const DataType&) { BaseClass::Setup(); }
-        using BaseClass::Setup;
-
-        /// Cleanup if needed.
-        virtual void Cleanup(const DataType&) { BaseClass::Cleanup(); }
-        using BaseClass::Cleanup;
+        std::optional<std::uint64_t> Cycles{};
+        std::optional<std::uint64_t> Instructions{};
+        std::optional<std::uint64_t> BranchMisses{};
+        std::optional<std::uint64_t> L1DMisses{};
+        std::optional<std::uint64_t> LLCMisses{};
+        std::optional<std::uint64_t> TaskClock{}; // In nanoseconds
+        std::optional<std::uint64_t> ContextSwitches{};
+        std::optional<std::uint64_t> PageFaults{};
     };
 
-    template<class T>
-    concept IsTableFixture =
-        requires
-        {
-            typename T::DataType;
-            typename T::BaseClass;
-        } &&
-        std::derived_from<T, TableFixture<typename T::DataType, typename T::BaseClass>>;
-
-    struct IFixtureWrapper
+    namespace Details
     {
-        IFixtureWrapper() = default;
-        IFixtureWrapper(const IFixtureWrapper&) = delete;
-        IFixtureWrapper(IFixtureWrapper&&) = delete;
-        virtual ~IFixtureWrapper() = default;
-        
-        IFixtureWrapper& operator=(const IFixtureWrapper&) = delete;
-        IFixtureWrapper& operator=(IFixtureWrapper&&) = delete;
-
-        virtual void MTest_Run() = 0;
-        virtual bool MTest_Skip() = 0;
-        virtual void MTest_Setup() = 0;
-        virtual void MTest_Cleanup() = 0;
-    };
-    using FixtureWrapperPtr = std::unique_ptr<IFixtureWrapper>;
+        struct PerfCounterField
+        {
+            std::optional<std::uint64_t> PerfCounterStats::*Member{};
+            const char* Name{};
+            const char* Key{}; // Used in structured output
+            std::uint32_t Type{};
+            std::uint64_t Config{};
+        };
 
-    enum class EFailType
-    {
-        Check,
-        Assert
-    };
+    #ifdef MTEST_LINUX_PLATFORM
+        inline constexpr std::array<PerfCounterField, 8uz> PerfCounterFields
+        {{
+            {&PerfCounterStats::Cycles, "Cycles", "cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {&PerfCounterStats::Instructions, "Instructions", "instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {&PerfCounterStats::BranchMisses, "Branch misses", "branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+            {&PerfCounterStats::L1DMisses, "L1D misses", "l1d_misses", PERF_TYPE_HW_CACHE,
+                PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8u) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16u)},
+            {&PerfCounterStats::LLCMisses, "LLC misses", "llc_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+            {&PerfCounterStats::TaskClock, "Task clock ns", "task_clock_ns", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+            {&PerfCounterStats::ContextSwitches, "Context switches", "context_switches", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES},
+            {&PerfCounterStats::PageFaults, "Page faults", "page_faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS}
+        }};
+    #else
+        inline constexpr std::array<PerfCounterField, 0uz> PerfCounterFields{};
+    #endif
 
-    enum class ETestResult
-    {
-        Success,
-        Fail,
-        Skip
-    };
+        /// Set before tests are run when --perf-counters is given.
+        constinit inline bool CollectPerfCounters{false};
 
-    namespace Details
-    {
-        inline std::string FailTypeToString(const EFailType type)
+        /// Counters of calling thread opened with perf_event_open. Hardware counters count only user space, so they work with perf_event_paranoid
+        /// up to 2. Software counters include kernel when allowed, as context switches happen there, and fall back to user space otherwise.
+        /// Counter which can not be opened, eg. hardware counter in container or virtual machine, is skipped.
+        class CPerfCounters final
         {
-            switch(type)
+        public:
+            CPerfCounters()
             {
-            case EFailType::Check:
-                return "[Check  ]";
-            case EFailType::Assert:
-                return "[Assert ]";
-            default:
-                return "[???????]";
+                Fds.fill(-1);
+                Open();
             }
-        }
+            CPerfCounters(const CPerfCounters&) = delete;
+            CPerfCounters(CPerfCounters&&) = delete;
+            ~CPerfCounters() { Close(); }
 
-        inline EConsoleColor TestResultToColor(const ETestResult result)
-        {
-            switch(result)
+            CPerfCounters& operator=(const CPerfCounters&) = delete;
+            CPerfCounters& operator=(CPerfCounters&&) = delete;
+
+            bool IsAvailable() const { return std::ranges::any_of(Fds, [](const int fd) { return fd >= 0; }); }
+            bool IsHardwareAvailable() const
             {
-            case ETestResult::Success:
-                return EConsoleColor::Green;
-            case ETestResult::Fail:
-                return EConsoleColor::Red;
-            case ETestResult::Skip:
-                return EConsoleColor::Magenta;
-            default:
-                return EConsoleColor::Default;
+            #ifdef MTEST_LINUX_PLATFORM
+                for(std::size_t i{0uz}; i < Fds.size(); ++i)
+                {
+                    if( Fds[i] >= 0 && PerfCounterFields[i].Type != PERF_TYPE_SOFTWARE )
+                    {
+                        return true;
+                    }
+                }
+            #endif
+                return false;
+            }
+
+            /// Current values, scaled if counter was multiplexed.
+            PerfCounterStats Read()
+            {
+                PerfCounterStats stats{};
+            #ifdef MTEST_LINUX_PLATFORM
+                // Forked worker process inherits counters of parent thread
+                if( Process != ::getpid() )
+                {
+                    Open();
+                }
+                for(std::size_t i{0uz}; i < Fds.size(); ++i)
+                {
+                    std::uint64_t values[3]{};
+                    if( Fds[i] < 0 || ::read(Fds[i], values, sizeof(values)) != static_cast<ssize_t>(sizeof(values)) )
+                    {
+                        continue;
+                    }
+                    const double scale = values[2] > 0u ? static_cast<double>(values[1]) / static_cast<double>(values[2]) : 1.0;
+                    stats.*PerfCounterFields[i].Member = static_cast<std::uint64_t>(static_cast<double>(values[0]) * scale);
+                }
+            #endif
+                return stats;
+            }
+        private:
+            void Open()
+            {
+                Close();
+            #ifdef MTEST_LINUX_PLATFORM
+                Process = ::getpid();
+                for(std::size_t i{0uz}; i < Fds.size(); ++i)
+                {
+                    perf_event_attr attr{};
+                    attr.size = sizeof(attr);
+                    attr.type = PerfCounterFields[i].Type;
+                    attr.config = PerfCounterFields[i].Config;
+                    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+                    const bool software = PerfCounterFields[i].Type == PERF_TYPE_SOFTWARE;
+                    if( software )
+                    {
+                        Fds[i] = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC));
+                    }
+                    // Context switches are never seen from user space, such counter would only read zero
+                    if( Fds[i] < 0 && !(software && attr.config == PERF_COUNT_SW_CONTEXT_SWITCHES) )
+                    {
+                        attr.exclude_kernel = 1;
+                        attr.exclude_hv = 1;
+                        Fds[i] = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC));
+                    }
+                }
+            #endif
+            }
+
+            void Close()
+            {
+                for(auto& i: Fds)
+                {
+                #ifdef MTEST_LINUX_PLATFORM
+                    if( i >= 0 )
+                    {
+                        ::close(i);
+                    }
+                #endif
+                    i = -1;
+                }
             }
+        private:
+            std::array<int, PerfCounterFields.size()> Fds{};
+        #ifdef MTEST_LINUX_PLATFORM
+            pid_t Process{};
+        #endif
+        };
+
+        inline CPerfCounters& GetPerfCounters()
+        {
+            thread_local CPerfCounters counters{};
+            return counters;
         }
 
-        inline std::string TestResultToString(const ETestResult result)
+        /// Difference of counters available in both values.
+        inline PerfCounterStats SubtractPerfCounters(const PerfCounterStats& end, const PerfCounterStats& start)
         {
-            switch(result)
+            PerfCounterStats result{};
+            for(const auto& i: PerfCounterFields)
             {
-            case ETestResult::Success:
-                return "[Success]";
-            case ETestResult::Fail:
-                return "[Failure]";
-            case ETestResult::Skip:
-                return "[Skipped]";
-            default:
-                return "[???????]";
+                if( (end.*i.Member) && (start.*i.Member) )
+                {
+                    result.*i.Member = *(end.*i.Member) - std::min(*(end.*i.Member), *(start.*i.Member));
+                }
             }
+            return result;
         }
 
-        inline std::string FilenameFromPath(const std::string& path)
+        inline void AddPerfCounters(PerfCounterStats& target, const PerfCounterStats& value)
         {
-            const auto idx = path.find_last_of("\\/");
-            if( idx == std::string::npos )
+            for(const auto& i: PerfCounterFields)
             {
-                return path;
+                if( value.*i.Member )
+                {
+                    target.*i.Member = (target.*i.Member).value_or(0u) + *(value.*i.Member);
+                }
             }
-            return path.substr(idx + 1uz);
         }
 
-        inline std::string FormatTime(const float timeInMS)
+        /// Format available counters, each divided by given value eg. number of iterations.
+        inline std::string FormatPerfCounters(const PerfCounterStats& stats, const double divisor = 1.0)
         {
-            const bool asSeconds = timeInMS >= 100.0f;
-            return std::format("({:.4f} {})", asSeconds ? timeInMS / 1000.0f : timeInMS, asSeconds ? "s" : "ms");
+            std::string result{};
+            for(const auto& i: PerfCounterFields)
+            {
+                if( stats.*i.Member )
+                {
+                    const double value = static_cast<double>(*(stats.*i.Member)) / divisor;
+                    result += divisor == 1.0 ? std::format("{}{}: {}", result.empty() ? "" : ", ", i.Name, *(stats.*i.Member)) :
+                        std::format("{}{}: {:.2f}", result.empty() ? "" : ", ", i.Name, value);
+                }
+            }
+            if( stats.Cycles && stats.Instructions && *stats.Cycles > 0u )
+            {
+                result += std::format(", IPC: {:.2f}", static_cast<double>(*stats.Instructions) / static_cast<double>(*stats.Cycles));
+            }
+            return result;
         }
 
-        template<IsPointerType T>
-        std::string FormatPointer(const T& pointer)
+        /// Adds counters of current thread measured during its lifetime to given stats.
+        class CPerfScope final
         {
-            if constexpr(std::is_null_pointer_v<T>)
+        public:
+            explicit CPerfScope(std::optional<PerfCounterStats>& target):
+                Target(target)
             {
-                // Special std::nullptr_t type in this case just return null.
-                return "null";
+                if( CollectPerfCounters )
+                {
+                    const CAllocationPause pause{};
+                    Start = GetPerfCounters().Read();
+                }
             }
-            else
+            CPerfScope(const CPerfScope&) = delete;
+            CPerfScope(CPerfScope&&) = delete;
+            ~CPerfScope()
             {
-                // If pointer is nullptr then return null and if not convert pointer to string.
-                return pointer == nullptr ? "null" : std::format("{}", static_cast<const void*>(pointer));
+                if( Start )
+                {
+                    if( !Target )
+                    {
+                        Target.emplace();
+                    }
+                    AddPerfCounters(*Target, SubtractPerfCounters(GetPerfCounters().Read(), *Start));
+                }
             }
-        }
+
+            CPerfScope& operator=(const CPerfScope&) = delete;
+            CPerfScope& operator=(CPerfScope&&) = delete;
+        private:
+            std::optional<PerfCounterStats>& Target;
+            std::optional<PerfCounterStats> Start{};
+        };
     }
 
-    class CTestAssertionException final: public std::runtime_error
+    namespace Details
     {
-    public:
-        CTestAssertionException():
-            std::runtime_error("Test Assertion")
+        /// Bounded lock-free queue for many producers and one consumer, based on Dmitry Vyukov's bounded queue.
+        template<class T>
+        class CMPSCQueue final
         {
-        }
-    };
+            struct Slot
+            {
+                std::atomic<std::size_t> Sequence{0uz};
+                T Value{};
+            };
+        public:
+            /// Capacity is rounded up to power of two.
+            explicit CMPSCQueue(const std::size_t capacity):
+                Mask(std::bit_ceil(std::max(capacity, 2uz)) - 1uz),
+                Slots(std::make_unique<Slot[]>(Mask + 1uz))
+            {
+                for(std::size_t i{0uz}; i <= Mask; ++i)
+                {
+                    Slots[i].Sequence.store(i, std::memory_order_relaxed);
+                }
+            }
+            CMPSCQueue(const CMPSCQueue&) = delete;
+            CMPSCQueue(CMPSCQueue&&) = delete;
+            ~CMPSCQueue() = default;
 
-    class CTestSkippedException final: public std::runtime_error
+            CMPSCQueue& operator=(const CMPSCQueue&) = delete;
+            CMPSCQueue& operator=(CMPSCQueue&&) = delete;
+
+            /// Returns false when queue is full, value is moved only on success. Can be called from any thread.
+            bool TryPush(T&& value)
+            {
+                std::size_t position = EnqueuePosition.load(std::memory_order_relaxed);
+                while( true )
+                {
+                    Slot& slot = Slots[position & Mask];
+                    const std::size_t sequence = slot.Sequence.load(std::memory_order_acquire);
+                    if( sequence == position )
+                    {
+                        if( EnqueuePosition.compare_exchange_weak(position, position + 1uz, std::memory_order_relaxed) )
+                        {
+                            slot.Value = std::move(value);
+                            slot.Sequence.store(position + 1uz, std::memory_order_release);
+                            return true;
+                        }
+                    }
+                    else if( sequence < position )
+                    {
+                        // Slot still holds value from previous lap.
+                        return false;
+                    }
+                    else
+                    {
+                        position = EnqueuePosition.load(std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            /// Returns false when next value is not published yet. Must be called only from consumer thread.
+            bool TryPop(T& value)
+            {
+                Slot& slot = Slots[DequeuePosition & Mask];
+                if( slot.Sequence.load(std::memory_order_acquire) != DequeuePosition + 1uz )
+                {
+                    return false;
+                }
+                value = std::move(slot.Value);
+                slot.Sequence.store(DequeuePosition + Mask + 1uz, std::memory_order_release);
+                ++DequeuePosition;
+                return true;
+            }
+
+            /// Number of values ever pushed or being pushed right now.
+            std::size_t GetReserved() const { return EnqueuePosition.load(std::memory_order_acquire); }
+        private:
+            std::size_t Mask{0uz};
+            std::unique_ptr<Slot[]> Slots{};
+            alignas(64) std::atomic<std::size_t> EnqueuePosition{0uz};
+            alignas(64) std::size_t DequeuePosition{0uz};
+        };
+    }
+
+    class CLog final
     {
+        /// Single record or whole buffer of one test case, so it is not interleaved with other output.
+        struct AsyncEntry
+        {
+            LogRecord Record{};
+            LogBuffer Batch{};
+        };
+        static constexpr std::size_t ASYNC_BATCH_SIZE = 256uz;
+    private:
+        CLog() = default;
     public:
-        CTestSkippedException():
-            std::runtime_error("Test Skipped")
+        CLog(const CLog&) = delete;
+        CLog(CLog&&) = delete;
+        ~CLog() { DisableAsync(); }
+
+        CLog& operator=(const CLog&) = delete;
+        CLog& operator=(CLog&&) = delete;
+
+        static CLog& Instance()
         {
+            static CLog log;
+            return log;
         }
-    };
 
-    /// Helper used to define custom near comparision
-    template<class T>
-    struct Approx;
+        // Create sink for test output
+        template<std::derived_from<ISink> T, class...Args>
+        void CreateSink(Args&&...args)
+        {
+            AddSink(std::make_unique<T>(std::forward<Args>(args)...));
+        }
 
-    template<class T, class E>
-    concept HasApproxDefined = requires(const T& value, const T& wanted, const E& epsilon)
-    {
-        {Approx<T>::IsNear(value, wanted, epsilon)} -> std::convertible_to<bool>;
-    };
+        void AddSink(std::unique_ptr<ISink> sink)
+        {
+            const std::lock_guard lock{Mutex};
+            Sinks.push_back(std::move(sink));
+        }
 
-    template<class T, class E>
-    bool IsNear(const T& value, const T& wanted, const E& epsilon)
-    {
-        if constexpr( HasApproxDefined<T, E> )
+        template<class...Args>
+        void Write(const EConsoleColor textColor, const std::format_string<Args...> fmt, Args&&...args)
         {
-            return Approx<T>::IsNear(value, wanted, epsilon);
+            const Details::CAllocationPause pause{};
+            Write(textColor, std::format(fmt, std::forward<Args>(args)...));
         }
-        else
+
+        void Write(const EConsoleColor textColor, const std::string& string)
         {
-            return std::abs(value - wanted) <= epsilon;
+            const Details::CAllocationPause pause{};
+            Write(LogRecord{textColor, true, string});
         }
-    }
 
-    /// Default epsilon
-    template<std::floating_point T>
-    inline constexpr T EPSILON = std::numeric_limits<T>::epsilon();
+        template<class...Args>
+        void Write(const std::format_string<Args...> fmt, Args&&...args)
+        {
+            const Details::CAllocationPause pause{};
+            Write(std::format(fmt, std::forward<Args>(args)...));
+        }
 
-    /// Small epsilon
-    template<std::floating_point T>
-    inline constexpr T EPSILON_SMALL = T{0.0001};
+        void Write(const std::string& string)
+        {
+            const Details::CAllocationPause pause{};
+            Write(LogRecord{EConsoleColor::Default, false, string});
+        }
 
-    /// User defined check result
-    using CheckResult = std::optional<std::string>;
-    /// Call to pass check
-    inline CheckResult CheckSuccess()
-    {
-        return std::nullopt;
-    }
-    /// Call to fail check
-    template<class...Args>
-    CheckResult CheckFailure(const std::format_string<Args...> fmt, Args&&...args)
-    {
-        return std::format(fmt, std::forward<Args>(args)...);
-    }
+        /// Write buffered output to sinks at once, so it is not interleaved with other output.
+        void Write(LogBuffer&& buffer)
+        {
+            const Details::CAllocationPause pause{};
+            if( Capture )
+            {
+                Capture->insert(Capture->end(), std::make_move_iterator(buffer.begin()), std::make_move_iterator(buffer.end()));
+                return;
+            }
+            if( IsAsync() )
+            {
+                Push({LogRecord{}, std::move(buffer)});
+                return;
+            }
+            const std::lock_guard lock{Mutex};
+            for(const auto& i: buffer)
+            {
+                WriteRecord(i);
+            }
+        }
 
-    /// Represents one test case
-    class CTestCase final
-    {
-        using TestClock = std::chrono::steady_clock;
-        using TestClockStamp = std::chrono::steady_clock::time_point;
-        using TestClockDuration = std::chrono::duration<float, std::milli>;
-    public:
-        CTestCase(const std::string& section, const std::string& name, const std::source_location location, FixtureWrapperPtr fixture):
-            Section(section),
-            Name(name),
-            Fullname(MakeFullname(section, name)),
-            File(Details::FilenameFromPath(location.file_name())),
-            Line(location.line()),
-            Fixture(std::move(fixture))
+        /// Pass structured event to all sinks.
+        template<IsInvocable<void, ISink&> Invocable>
+        void Notify(Invocable invocable)
         {
+            const std::lock_guard lock{Mutex};
+            for(const auto& i: Sinks)
+            {
+                invocable(*i);
+            }
         }
-        CTestCase(const CTestCase&) = delete;
-        CTestCase(CTestCase&&) = delete;
-        ~CTestCase() = default;
-        
-        CTestCase& operator=(const CTestCase&) = delete;
-        CTestCase& operator=(CTestCase&&) = delete;
 
-        const std::string& GetSection() const { return Section; }
-        const std::string& GetName() const { return Name; }
-        const std::string& GetFullname() const { return Fullname; }
-        const std::string& GetFile() const { return File; }
-        std::uint_least32_t GetLine() const { return Line; }
-        bool IsFailed() const { return Result == ETestResult::Fail; }
-        bool IsSkipped() const { return Result == ETestResult::Skip; }
-        ETestResult GetResult() const { return Result; }
-        float GetDuration() const { return Duration; }
+        /// Redirect output of the calling thread to buffer, nullptr restores writing to sinks. Returns previous buffer.
+        LogBuffer* SetCapture(LogBuffer* buffer)
+        {
+            return std::exchange(Capture, buffer);
+        }
 
-        static std::string MakeFullname(const std::string& section, const std::string& name) { return std::format("{}.{}", section, name); }
+        /// Write to sinks on background thread, producers only push records to lock-free queue. When queue is full producers wait.
+        /// Must not be called while tests are running.
+        void EnableAsync(const std::size_t capacity = 8192uz)
+        {
+            if( Queue )
+            {
+                return;
+            }
+            Queue = std::make_unique<Details::CMPSCQueue<AsyncEntry>>(capacity);
+            Written.store(0uz, std::memory_order_relaxed);
+            Stopping.store(false, std::memory_order_relaxed);
+            Consumer = std::make_unique<std::thread>([this]() { ConsumerLoop(); });
+            ConsumerId = Consumer->get_id();
+            Async.store(true, std::memory_order_release);
+            PreviousTerminate = std::set_terminate(&CLog::OnTerminate);
+        #ifdef MTEST_LINUX_PLATFORM
+            for(std::size_t i{0uz}; i < std::size(FATAL_SIGNALS); ++i)
+            {
+                struct sigaction action{};
+                action.sa_handler = &CLog::OnFatalSignal;
+                sigemptyset(&action.sa_mask);
+                action.sa_flags = static_cast<int>(SA_RESETHAND);
+                sigaction(FATAL_SIGNALS[i], &action, &PreviousSignals[i]);
+            }
+        #endif
+        }
 
-        bool IsRun(const std::string& filter) const
+        /// Write all pending records and stop background thread.
+        void DisableAsync()
         {
-            if( !filter.empty() )
+            if( !Queue )
             {
-                return GetFullname().contains(filter);
+                return;
+            }
+            Flush();
+            Async.store(false, std::memory_order_release);
+            Stopping.store(true, std::memory_order_release);
+            Wake.fetch_add(1u, std::memory_order_release);
+            Wake.notify_one();
+            Consumer->join();
+            Consumer.reset();
+            Queue.reset();
+            std::set_terminate(PreviousTerminate);
+        #ifdef MTEST_LINUX_PLATFORM
+            for(std::size_t i{0uz}; i < std::size(FATAL_SIGNALS); ++i)
+            {
+                sigaction(FATAL_SIGNALS[i], &PreviousSignals[i], nullptr);
+            }
+        #endif
+        }
+
+        /// Called before fork, sinks are flushed and locked, so child neither inherits locked mutex nor writes output of parent again.
+        void BeginFork()
+        {
+            Flush();
+            Mutex.lock();
+            FlushSinks();
+            std::fflush(nullptr);
+        }
+
+        /// Called after fork in both processes. Forking thread owns mutex in child too, so it is released there as well.
+        void EndFork(const bool child)
+        {
+            if( child )
+            {
+                AbandonAsync();
+            }
+            Mutex.unlock();
+        }
+
+        bool IsAsync() const { return Async.load(std::memory_order_acquire); }
+
+        /// Wait until everything written so far reaches sinks and flush them.
+        void Flush()
+        {
+            if( IsAsync() && std::this_thread::get_id() != ConsumerId )
+            {
+                const std::size_t target = Queue->GetReserved();
+                std::size_t written = Written.load(std::memory_order_acquire);
+                while( written < target )
+                {
+                    Written.wait(written, std::memory_order_acquire);
+                    written = Written.load(std::memory_order_acquire);
+                }
+            }
+            const std::lock_guard lock{Mutex};
+            FlushSinks();
+        }
+    private:
+        void Write(LogRecord&& record)
+        {
+            if( Capture )
+            {
+                Capture->push_back(std::move(record));
+                return;
+            }
+            if( IsAsync() )
+            {
+                Push({std::move(record), {}});
+                return;
+            }
+            const std::lock_guard lock{Mutex};
+            WriteRecord(record);
+        }
+
+        void Push(AsyncEntry&& entry)
+        {
+            while( !Queue->TryPush(std::move(entry)) )
+            {
+                // Queue is full, let consumer catch up.
+                Wake.notify_one();
+                std::this_thread::yield();
+            }
+            Wake.fetch_add(1u, std::memory_order_release);
+            Wake.notify_one();
+        }
+
+        void ConsumerLoop()
+        {
+            std::vector<AsyncEntry> batch{};
+            batch.reserve(ASYNC_BATCH_SIZE);
+            std::size_t consumed{0uz};
+            while( true )
+            {
+                const auto seen = Wake.load(std::memory_order_acquire);
+                AsyncEntry entry{};
+                while( batch.size() < ASYNC_BATCH_SIZE && Queue->TryPop(entry) )
+                {
+                    batch.push_back(std::move(entry));
+                }
+                if( !batch.empty() )
+                {
+                    const std::lock_guard lock{Mutex};
+                    for(const auto& i: batch)
+                    {
+                        WriteRecord(i.Record);
+                        for(const auto& j: i.Batch)
+                        {
+                            WriteRecord(j);
+                        }
+                    }
+                    consumed += batch.size();
+                    batch.clear();
+                    // Queue drained, do not keep output in sinks buffers.
+                    if( Queue->GetReserved() == consumed )
+                    {
+                        FlushSinks();
+                    }
+                    Written.store(consumed, std::memory_order_release);
+                    Written.notify_all();
+                    continue;
+                }
+                if( Queue->GetReserved() != consumed )
+                {
+                    // Value is reserved but not published yet.
+                    std::this_thread::yield();
+                    continue;
+                }
+                if( Stopping.load(std::memory_order_acquire) )
+                {
+                    return;
+                }
+                Wake.wait(seen, std::memory_order_acquire);
+            }
+        }
+
+        static void OnTerminate()
+        {
+            Instance().Flush();
+            if( Instance().PreviousTerminate )
+            {
+                Instance().PreviousTerminate();
+            }
+            std::abort();
+        }
+
+        /// Forget background thread without joining it, used in forked process where that thread does not exist.
+        void AbandonAsync()
+        {
+            Async.store(false, std::memory_order_release);
+            std::ignore = Consumer.release();
+            std::ignore = Queue.release();
+        }
+
+    #ifdef MTEST_LINUX_PLATFORM
+        static constexpr int FATAL_SIGNALS[] = {SIGSEGV, SIGABRT, SIGBUS, SIGFPE, SIGILL};
+
+        /// Give background thread a moment to write pending records, then let signal do action which was installed before.
+        static void OnFatalSignal(const int signal)
+        {
+            CLog& log = Instance();
+            if( log.IsAsync() && std::this_thread::get_id() != log.ConsumerId )
+            {
+                for(int i{0}; i < 1000 && log.Written.load(std::memory_order_acquire) < log.Queue->GetReserved(); ++i)
+                {
+                    const timespec delay{0, 1'000'000};
+                    nanosleep(&delay, nullptr);
+                }
+            }
+            for(std::size_t i{0uz}; i < std::size(FATAL_SIGNALS); ++i)
+            {
+                if( FATAL_SIGNALS[i] == signal )
+                {
+                    sigaction(signal, &log.PreviousSignals[i], nullptr);
+                }
+            }
+            raise(signal);
+        }
+    #endif
+
+        void WriteRecord(const LogRecord& record)
+        {
+            if( record.HasColor )
+            {
+                WriteColored(record.Color, record.Text);
+            }
+            else
+            {
+                WritePlain(record.Text);
+            }
+        }
+
+        void WriteColored(const EConsoleColor textColor, const std::string& string)
+        {
+            SetColor(textColor);
+            WritePlain(string);
+            SetColor(EConsoleColor::Default);
+        }
+
+        void WritePlain(const std::string& string)
+        {
+            for(const auto& i: Sinks)
+            {
+                i->Write(string);
+            }
+        }
+
+        void SetColor(const EConsoleColor textColor)
+        {
+            for(const auto& i: Sinks)
+            {
+                i->SetColor(textColor);
+            }
+        }
+
+        void FlushSinks()
+        {
+            for(const auto& i: Sinks)
+            {
+                i->Flush();
+            }
+        }
+    private:
+        std::vector<std::unique_ptr<ISink>> Sinks{};
+        std::mutex Mutex{};
+        static inline thread_local LogBuffer* Capture{};
+        // Asynchronous mode
+        std::atomic<bool> Async{false};
+        std::atomic<bool> Stopping{false};
+        std::atomic<std::uint32_t> Wake{0u};
+        std::atomic<std::size_t> Written{0uz};
+        std::unique_ptr<Details::CMPSCQueue<AsyncEntry>> Queue{};
+        std::unique_ptr<std::thread> Consumer{};
+        std::thread::id ConsumerId{};
+        std::terminate_handler PreviousTerminate{};
+    #ifdef MTEST_LINUX_PLATFORM
+        std::array<struct sigaction, std::size(FATAL_SIGNALS)> PreviousSignals{};
+    #endif
+    };
+    inline CLog& GetLog() { return CLog::Instance(); }
+
+    /// Can be used to init some data before each test. Test function has access to its internals (excluding private) - prefer structs (public default access).
+    struct Fixture
+    {
+        Fixture() = default;
+        Fixture(const Fixture&) = delete;
+        Fixture(Fixture&&) = delete;
+        virtual ~Fixture() = default;
+        
+        Fixture& operator=(const Fixture&) = delete;
+        Fixture& operator=(Fixture&&) = delete;
+
+        /// Should return true if test case should be skipped.
+        virtual bool Skip() { return false; }
+        /// Use Assertions to check state.
+        virtual void Setup() {}
+        /// Cleanup if needed.
+        virtual void Cleanup() {}
+        /// Time limit of each run of test case, zero uses limit given by --timeout.
+        virtual std::chrono::milliseconds Timeout() { return std::chrono::milliseconds{0}; }
+    };
+
+    /// Table test data array
+    template<class T>
+    using TableDataArray = std::vector<T>;
+
+    template<class T>
+    concept IsTableDataArray = 
+        requires { typename T::value_type; } &&
+        std::same_as<T, std::vector<typename T::value_type>>;
+
+    /// Fixture to use with Table tests.
+    template<class Type, std::derived_from<Fixture> Base>
+    struct TableFixture: Base
+    {
+        using DataType = Type;
+        using BaseClass = Base;
+
+        TableFixture() = default;
+        virtual ~TableFixture() = default;
+
+        /// Get Test case name. Fixture is made just to call it, so define static GenerateRowName with same parameters to avoid that.
+        virtual std::string GenerateName(const DataType&, const std::size_t i) { return std::to_string(i); }
+
+        /// Should return true if test case should be skipped.
+        virtual bool Skip(const DataType&) { return BaseClass::Skip(); }
+        using BaseClass::Skip;
+
+        /// Use Assertions to check state.
+        virtual void Setup(const DataType&) { BaseClass::Setup(); }
+        using BaseClass::Setup;
+
+        /// Cleanup if needed.
+        virtual void Cleanup(const DataType&) { BaseClass::Cleanup(); }
+        using BaseClass::Cleanup;
+    };
+
+    /// Produces rows of table test on demand from their index.
+    template<class T>
+    struct TableGenerator
+    {
+        using DataType = T;
+
+        std::size_t Count{};
+        std::function<T(std::size_t)> Make{};
+
+        std::size_t size() const { return Count; }
+        T operator[](const std::size_t i) const { return Make(i); }
+    };
+
+    /// Any sized container or view which can make row from index, eg. std::views::iota | std::views::transform or TableGenerator.
+    template<class T>
+    concept IsTableGenerator =
+        requires(const T& generator, const std::size_t i)
+        {
+            { std::size(generator) } -> std::convertible_to<std::size_t>;
+            generator[i];
+        };
+
+    template<class T>
+    concept IsTableFixture =
+        requires
+        {
+            typename T::DataType;
+            typename T::BaseClass;
+        } &&
+        std::derived_from<T, TableFixture<typename T::DataType, typename T::BaseClass>>;
+
+    /// Table fixture which names rows by static GenerateRowName(row, index), it is called without making fixture.
+    template<class T>
+    concept HasStaticRowName =
+        requires(const typename T::DataType& row, const std::size_t i)
+        {
+            { T::GenerateRowName(row, i) } -> std::convertible_to<std::string>;
+        };
+
+    namespace Details
+    {
+        template<class T>
+        struct MemberClass;
+
+        template<class R, class C>
+        struct MemberClass<R C::*>
+        {
+            using Type = C;
+        };
+
+        /// Name of table row: static GenerateRowName, then overridden GenerateName called on given fixture or on fixture made for it,
+        /// otherwise index. Only overridden GenerateName needs fixture.
+        template<IsTableFixture T>
+        std::string GenerateRowName(const typename T::DataType& row, const std::size_t i, T* fixture)
+        {
+            if constexpr( HasStaticRowName<T> )
+            {
+                return T::GenerateRowName(row, i);
+            }
+            else if constexpr( std::same_as<typename MemberClass<decltype(&T::GenerateName)>::Type, TableFixture<typename T::DataType, typename T::BaseClass>> )
+            {
+                return std::to_string(i);
+            }
+            else if( fixture )
+            {
+                return fixture->GenerateName(row, i);
+            }
+            else
+            {
+                return T(row, i).GenerateName(row, i);
+            }
+        }
+    }
+
+    /// Coroutine of async test case or of async helper called from it. It starts when it is awaited, exception is passed to awaiter.
+    class [[nodiscard]] Task final
+    {
+    public:
+        struct promise_type
+        {
+            std::coroutine_handle<> Continuation{};
+            std::exception_ptr Exception{};
+
+            Task get_return_object() { return Task{std::coroutine_handle<promise_type>::from_promise(*this)}; }
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            auto final_suspend() noexcept
+            {
+                // Awaiting coroutine continues right away, root coroutine stays suspended so its owner sees it done.
+                struct FinalAwaiter
+                {
+                    bool await_ready() noexcept { return false; }
+                    std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+                    {
+                        const auto continuation = handle.promise().Continuation;
+                        return continuation ? continuation : std::noop_coroutine();
+                    }
+                    void await_resume() noexcept {}
+                };
+                return FinalAwaiter{};
+            }
+            void return_void() {}
+            void unhandled_exception() { Exception = std::current_exception(); }
+        };
+        using Handle = std::coroutine_handle<promise_type>;
+
+        Task() = default;
+        explicit Task(const Handle handle):
+            Coroutine(handle)
+        {
+        }
+        Task(const Task&) = delete;
+        Task(Task&& other) noexcept:
+            Coroutine(std::exchange(other.Coroutine, {}))
+        {
+        }
+        ~Task()
+        {
+            if( Coroutine )
+            {
+                Coroutine.destroy();
+            }
+        }
+
+        Task& operator=(const Task&) = delete;
+        Task& operator=(Task&& other) noexcept
+        {
+            if( this != &other )
+            {
+                if( Coroutine )
+                {
+                    Coroutine.destroy();
+                }
+                Coroutine = std::exchange(other.Coroutine, {});
+            }
+            return *this;
+        }
+
+        Handle GetHandle() const { return Coroutine; }
+        bool IsDone() const { return !Coroutine || Coroutine.done(); }
+        /// Rethrow exception which has ended coroutine.
+        void Rethrow() const
+        {
+            if( Coroutine && Coroutine.promise().Exception )
+            {
+                std::rethrow_exception(Coroutine.promise().Exception);
+            }
+        }
+
+        bool await_ready() const noexcept { return IsDone(); }
+        std::coroutine_handle<> await_suspend(const std::coroutine_handle<> awaiter) noexcept
+        {
+            Coroutine.promise().Continuation = awaiter;
+            return Coroutine;
+        }
+        void await_resume() const { Rethrow(); }
+    private:
+        Handle Coroutine{};
+    };
+
+    struct IFixtureWrapper
+    {
+        IFixtureWrapper() = default;
+        IFixtureWrapper(const IFixtureWrapper&) = delete;
+        IFixtureWrapper(IFixtureWrapper&&) = delete;
+        virtual ~IFixtureWrapper() = default;
+        
+        IFixtureWrapper& operator=(const IFixtureWrapper&) = delete;
+        IFixtureWrapper& operator=(IFixtureWrapper&&) = delete;
+
+        virtual void MTest_Run() = 0;
+        virtual bool MTest_Skip() = 0;
+        virtual void MTest_Setup() = 0;
+        virtual void MTest_Cleanup() = 0;
+        /// Name of table test row.
+        virtual std::string MTest_GenerateName() { return {}; }
+        virtual std::chrono::milliseconds MTest_Timeout() { return std::chrono::milliseconds{0}; }
+        /// Body of async test case.
+        virtual Task MTest_RunAsync() { co_return; }
+    };
+    using FixtureWrapperPtr = std::unique_ptr<IFixtureWrapper>;
+    /// Creates fixture of test case, it is called right before Setup.
+    using FixtureFactory = std::function<FixtureWrapperPtr()>;
+
+    enum class EFailType
+    {
+        Check,
+        Assert,
+        Fatal
+    };
+
+    enum class ETestResult
+    {
+        Success,
+        Fail,
+        Skip
+    };
+
+    /// Single failure of test case, file is empty for fatal errors.
+    struct TestFailure
+    {
+        EFailType Type{EFailType::Check};
+        std::string Message{};
+        std::string File{};
+        std::uint_least32_t Line{};
+    };
+
+    /// Totals reported at the end of run, time is in milliseconds.
+    struct RunSummary
+    {
+        std::size_t Successful{0uz};
+        std::size_t Failed{0uz};
+        std::size_t Skipped{0uz};
+        float Duration{0.0f};
+    };
+
+    namespace Details
+    {
+        inline std::string FailTypeToString(const EFailType type)
+        {
+            switch(type)
+            {
+            case EFailType::Check:
+                return "[Check  ]";
+            case EFailType::Assert:
+                return "[Assert ]";
+            case EFailType::Fatal:
+                return "[Fatal  ]";
+            default:
+                return "[???????]";
+            }
+        }
+
+        /// Name used in structured output.
+        inline std::string FailTypeToName(const EFailType type)
+        {
+            switch(type)
+            {
+            case EFailType::Check:
+                return "check";
+            case EFailType::Assert:
+                return "assert";
+            case EFailType::Fatal:
+                return "fatal";
+            default:
+                return "unknown";
+            }
+        }
+
+        /// Name used in structured output.
+        inline std::string TestResultToName(const ETestResult result)
+        {
+            switch(result)
+            {
+            case ETestResult::Success:
+                return "success";
+            case ETestResult::Fail:
+                return "failure";
+            case ETestResult::Skip:
+                return "skipped";
+            default:
+                return "unknown";
+            }
+        }
+
+        inline EConsoleColor TestResultToColor(const ETestResult result)
+        {
+            switch(result)
+            {
+            case ETestResult::Success:
+                return EConsoleColor::Green;
+            case ETestResult::Fail:
+                return EConsoleColor::Red;
+            case ETestResult::Skip:
+                return EConsoleColor::Magenta;
+            default:
+                return EConsoleColor::Default;
+            }
+        }
+
+        inline std::string TestResultToString(const ETestResult result)
+        {
+            switch(result)
+            {
+            case ETestResult::Success:
+                return "[Success]";
+            case ETestResult::Fail:
+                return "[Failure]";
+            case ETestResult::Skip:
+                return "[Skipped]";
+            default:
+                return "[???????]";
+            }
+        }
+
+        inline std::string FilenameFromPath(const std::string& path)
+        {
+            const auto idx = path.find_last_of("\\/");
+            if( idx == std::string::npos )
+            {
+                return path;
+            }
+            return path.substr(idx + 1uz);
+        }
+
+        inline std::string FormatTime(const float timeInMS)
+        {
+            const bool asSeconds = timeInMS >= 100.0f;
+            return std::format("({:.4f} {})", asSeconds ? timeInMS / 1000.0f : timeInMS, asSeconds ? "s" : "ms");
+        }
+
+        /// Returns value of command line option given as 'name=value'.
+        inline std::string OptionValue(const std::string& option)
+        {
+            return option.substr(option.find_first_of('=') + 1uz);
+        }
+
+        /// Parse unsigned number, returns nothing if text is not a number.
+        inline std::optional<std::size_t> ParseNumber(const std::string& text)
+        {
+            std::size_t value{0uz};
+            const auto [ptr, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+            if( error != std::errc{} || ptr != text.data() + text.size() )
+            {
+                return std::nullopt;
+            }
+            return value;
+        }
+
+        /// Stable 64-bit FNV-1a hash, same on every platform and build.
+        inline std::uint64_t Hash(const std::string_view text)
+        {
+            std::uint64_t hash{14695981039346656037ull};
+            for(const char i: text)
+            {
+                hash ^= static_cast<unsigned char>(i);
+                hash *= 1099511628211ull;
+            }
+            return hash;
+        }
+
+        /// Small random generator (SplitMix64), it gives same sequence on every platform so shuffled order can be replayed from seed.
+        class CRandom final
+        {
+        public:
+            explicit CRandom(const std::uint64_t seed):
+                State(seed)
+            {
+            }
+
+            std::uint64_t Next()
+            {
+                std::uint64_t z = (State += 0x9E3779B97F4A7C15ull);
+                z = (z ^ (z >> 30u)) * 0xBF58476D1CE4E5B9ull;
+                z = (z ^ (z >> 27u)) * 0x94D049BB133111EBull;
+                return z ^ (z >> 31u);
+            }
+
+            /// Number in range [0, bound), bound must be greater than zero.
+            std::size_t Below(const std::size_t bound)
+            {
+                const std::uint64_t limit = std::numeric_limits<std::uint64_t>::max() - std::numeric_limits<std::uint64_t>::max() % bound;
+                std::uint64_t value{};
+                do
+                {
+                    value = Next();
+                }
+                while( value >= limit );
+                return static_cast<std::size_t>(value % bound);
+            }
+
+            /// Fisher-Yates shuffle.
+            template<class T>
+            void Shuffle(std::vector<T>& items)
+            {
+                for(std::size_t i = items.size(); i > 1uz; --i)
+                {
+                    std::swap(items[i-1uz], items[Below(i)]);
+                }
+            }
+        private:
+            std::uint64_t State{};
+        };
+
+        /// Read whole text file split into lines, returns nothing if file can not be opened.
+        inline std::optional<std::vector<std::string>> ReadLines(const std::string& path)
+        {
+            std::FILE* file = std::fopen(path.c_str(), "rb");
+            if( !file )
+            {
+                return std::nullopt;
+            }
+            std::string content{};
+            char buffer[4096];
+            std::size_t size{0uz};
+            while( (size = std::fread(buffer, 1uz, sizeof(buffer), file)) > 0uz )
+            {
+                content.append(buffer, size);
+            }
+            std::fclose(file);
+            std::vector<std::string> lines{};
+            std::size_t begin{0uz};
+            while( begin < content.size() )
+            {
+                std::size_t end = content.find('\n', begin);
+                if( end == std::string::npos )
+                {
+                    end = content.size();
+                }
+                std::string line = content.substr(begin, end - begin);
+                if( line.ends_with('\r') )
+                {
+                    line.pop_back();
+                }
+                if( !line.empty() )
+                {
+                    lines.push_back(std::move(line));
+                }
+                begin = end + 1uz;
+            }
+            return lines;
+        }
+
+        /// Read only view of whole file. File is memory mapped where supported, otherwise it is read into memory.
+        class CMappedFile final
+        {
+        public:
+            CMappedFile() = default;
+            CMappedFile(const CMappedFile&) = delete;
+            CMappedFile(CMappedFile&&) = delete;
+            ~CMappedFile() { Close(); }
+
+            CMappedFile& operator=(const CMappedFile&) = delete;
+            CMappedFile& operator=(CMappedFile&&) = delete;
+
+            bool Open(const std::string& path)
+            {
+                Close();
+            #ifdef MTEST_LINUX_PLATFORM
+                const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+                if( fd < 0 )
+                {
+                    return false;
+                }
+                struct stat info{};
+                if( ::fstat(fd, &info) != 0 )
+                {
+                    ::close(fd);
+                    return false;
+                }
+                const auto size = static_cast<std::size_t>(info.st_size);
+                if( size > 0uz )
+                {
+                    void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                    if( mapping == MAP_FAILED )
+                    {
+                        ::close(fd);
+                        return false;
+                    }
+                    // Rows are usually read in order
+                    ::madvise(mapping, size, MADV_SEQUENTIAL);
+                    Mapping = mapping;
+                    Data = std::string_view{static_cast<const char*>(mapping), size};
+                }
+                ::close(fd);
+                return true;
+            #else
+                std::FILE* file = std::fopen(path.c_str(), "rb");
+                if( !file )
+                {
+                    return false;
+                }
+                char buffer[4096];
+                std::size_t size{0uz};
+                while( (size = std::fread(buffer, 1uz, sizeof(buffer), file)) > 0uz )
+                {
+                    Buffer.append(buffer, size);
+                }
+                std::fclose(file);
+                Data = Buffer;
+                return true;
+            #endif
+            }
+
+            std::string_view GetData() const { return Data; }
+        private:
+            void Close()
+            {
+            #ifdef MTEST_LINUX_PLATFORM
+                if( Mapping )
+                {
+                    ::munmap(Mapping, Data.size());
+                    Mapping = nullptr;
+                }
+            #endif
+                Buffer.clear();
+                Data = {};
+            }
+        private:
+        #ifdef MTEST_LINUX_PLATFORM
+            void* Mapping{nullptr};
+        #endif
+            std::string Buffer{};
+            std::string_view Data{};
+        };
+
+        /// How records of dataset file are found.
+        enum class EDatasetRecords
+        {
+            None, // Binary file, it is not indexed
+            Lines, // Each non empty line is record
+            Csv // Non empty lines, line break inside quoted field does not end record
+        };
+
+        /// File of table dataset, it is opened on first access so nothing is loaded during static init.
+        /// Text files are indexed by starts of records.
+        class CDatasetFile final
+        {
+        public:
+            CDatasetFile(std::string path, const EDatasetRecords records, const std::size_t skipLines):
+                Path(std::move(path)),
+                Records(records),
+                SkipLines(skipLines)
+            {
+            }
+
+            /// Throws if file could not be opened.
+            std::string_view GetData() const
+            {
+                Load();
+                if( !Error.empty() )
+                {
+                    throw std::runtime_error(Error);
+                }
+                return File.GetData();
+            }
+
+            bool IsValid() const
+            {
+                Load();
+                return Error.empty();
+            }
+
+            std::size_t GetLineCount() const
+            {
+                Load();
+                return Lines.size();
+            }
+
+            std::string_view GetLine(const std::size_t i) const
+            {
+                const std::string_view data = GetData();
+                if( i >= Lines.size() )
+                {
+                    throw std::out_of_range(std::format("Line {} is out of range of dataset '{}'", i, Path));
+                }
+                const std::size_t begin = Lines[i];
+                std::string_view line = data.substr(begin, FindRecordEnd(data, begin) - begin);
+                if( line.ends_with('\r') )
+                {
+                    line.remove_suffix(1uz);
+                }
+                return line;
+            }
+        private:
+            void Load() const
+            {
+                std::call_once(Loaded, [this]()
+                {
+                    if( !File.Open(Path) )
+                    {
+                        Error = std::format("Unable to open dataset file '{}'", Path);
+                        return;
+                    }
+                    if( Records == EDatasetRecords::None )
+                    {
+                        return;
+                    }
+                    const std::string_view data = File.GetData();
+                    std::size_t skipped{0uz};
+                    std::size_t begin{0uz};
+                    while( begin < data.size() )
+                    {
+                        const std::size_t end = FindRecordEnd(data, begin);
+                        if( end == std::string_view::npos )
+                        {
+                            Lines.clear();
+                            Error = std::format("Quoted field of record which starts at byte {} of dataset file '{}' is not closed", begin, Path);
+                            return;
+                        }
+                        const std::size_t length = end - begin - (end > begin && data[end-1uz] == '\r' ? 1uz : 0uz);
+                        if( length > 0uz && skipped++ >= SkipLines )
+                        {
+                            Lines.push_back(begin);
+                        }
+                        begin = end + 1uz;
+                    }
+                });
+            }
+
+            /// End of record which starts at given offset, it is line break or end of data. Returns npos if CSV quote is not closed.
+            std::size_t FindRecordEnd(const std::string_view data, const std::size_t begin) const
+            {
+                if( Records != EDatasetRecords::Csv )
+                {
+                    return std::min(data.find('\n', begin), data.size());
+                }
+                bool quoted{false};
+                for(std::size_t i = begin; i < data.size(); ++i)
+                {
+                    if( data[i] == '"' )
+                    {
+                        quoted = !quoted;
+                    }
+                    else if( data[i] == '\n' && !quoted )
+                    {
+                        return i;
+                    }
+                }
+                return quoted ? std::string_view::npos : data.size();
+            }
+        private:
+            std::string Path{};
+            EDatasetRecords Records{EDatasetRecords::None};
+            std::size_t SkipLines{0uz};
+            mutable std::once_flag Loaded{};
+            mutable CMappedFile File{};
+            mutable std::vector<std::size_t> Lines{};
+            mutable std::string Error{};
+        };
+
+        /// Parse text field of dataset record.
+        template<class T>
+        T ParseField(const std::string_view text)
+        {
+            if constexpr( std::is_same_v<T, std::string_view> )
+            {
+                return text;
+            }
+            else if constexpr( std::is_same_v<T, std::string> )
+            {
+                return std::string{text};
+            }
+            else if constexpr( std::is_same_v<T, bool> )
+            {
+                if( text == "true" || text == "1" )
+                {
+                    return true;
+                }
+                if( text == "false" || text == "0" )
+                {
+                    return false;
+                }
+                throw std::invalid_argument(std::format("Unable to parse '{}' as bool", text));
+            }
+            else
+            {
+                static_assert(std::is_arithmetic_v<T>, "Field type must be arithmetic, std::string or std::string_view");
+                T value{};
+                const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+                if( error != std::errc{} || end != text.data() + text.size() )
+                {
+                    throw std::invalid_argument(std::format("Unable to parse '{}' as number", text));
+                }
+                return value;
+            }
+        }
+
+        /// Load test durations in milliseconds keyed by test full name. Each line of file is: duration full_name
+        inline std::optional<std::unordered_map<std::string, float>> LoadTimings(const std::string& path)
+        {
+            const auto lines = ReadLines(path);
+            if( !lines )
+            {
+                return std::nullopt;
+            }
+            std::unordered_map<std::string, float> timings{};
+            for(const auto& i: *lines)
+            {
+                const auto separator = i.find(' ');
+                if( separator == std::string::npos )
+                {
+                    continue;
+                }
+                float duration{0.0f};
+                const auto [ptr, error] = std::from_chars(i.data(), i.data() + separator, duration);
+                if( error == std::errc{} && ptr == i.data() + separator )
+                {
+                    timings[i.substr(separator + 1uz)] = duration;
+                }
+            }
+            return timings;
+        }
+
+        /// Write whole file aside and rename it, so reader never sees it partially written. Missing directories are created.
+        inline bool ReplaceFile(const std::string& path, const std::string& content)
+        {
+            std::error_code error{};
+            const std::filesystem::path file{path};
+            if( file.has_parent_path() )
+            {
+                std::filesystem::create_directories(file.parent_path(), error);
+            }
+            const std::string temporary = std::format("{}.{}.tmp", path, std::random_device{}());
+            std::FILE* handle = std::fopen(temporary.c_str(), "w");
+            if( !handle )
+            {
+                return false;
+            }
+            const bool written = std::fwrite(content.data(), 1uz, content.size(), handle) == content.size();
+            if( std::fclose(handle) == 0 && written )
+            {
+                std::filesystem::rename(temporary, file, error);
+                if( !error )
+                {
+                    return true;
+                }
+            }
+            std::filesystem::remove(temporary, error);
+            return false;
+        }
+
+        /// Save test durations in format read by LoadTimings.
+        inline bool SaveTimings(const std::string& path, const std::unordered_map<std::string, float>& timings)
+        {
+            std::vector<std::pair<std::string_view, float>> sorted(timings.begin(), timings.end());
+            std::ranges::sort(sorted);
+            std::string content{};
+            for(const auto& [name, duration]: sorted)
+            {
+                content += std::format("{:.3f} {}\n", duration, name);
+            }
+            return ReplaceFile(path, content);
+        }
+
+        /// Load results of previous run keyed by test case. Each line of file is: result key, where result is 'P' for passed
+        /// and 'F' for failed test case.
+        inline std::optional<std::unordered_map<std::string, ETestResult>> LoadResults(const std::string& path)
+        {
+            const auto lines = ReadLines(path);
+            if( !lines )
+            {
+                return std::nullopt;
+            }
+            std::unordered_map<std::string, ETestResult> results{};
+            for(const auto& i: *lines)
+            {
+                if( i.size() > 2uz && i[1] == ' ' && (i[0] == 'P' || i[0] == 'F') )
+                {
+                    results[i.substr(2uz)] = i[0] == 'F' ? ETestResult::Fail : ETestResult::Success;
+                }
+            }
+            return results;
+        }
+
+        /// Save results in format read by LoadResults.
+        inline bool SaveResults(const std::string& path, const std::unordered_map<std::string, ETestResult>& results)
+        {
+            std::vector<std::pair<std::string_view, ETestResult>> sorted(results.begin(), results.end());
+            std::ranges::sort(sorted);
+            std::string content{};
+            for(const auto& [key, result]: sorted)
+            {
+                content += std::format("{} {}\n", result == ETestResult::Fail ? 'F' : 'P', key);
+            }
+            return ReplaceFile(path, content);
+        }
+
+        /// Task with its expected duration.
+        struct ScheduledTask
+        {
+            std::size_t Index{0uz};
+            float Cost{0.0f};
+        };
+
+        /// Order tasks longest first by known durations. Tasks with unknown duration go first with average known duration,
+        /// as they may be long too. Returns empty schedule when no duration is known.
+        inline std::vector<ScheduledTask> ScheduleLongestFirst(const std::vector<std::optional<float>>& durations)
+        {
+            std::vector<ScheduledTask> unknown{};
+            std::vector<ScheduledTask> known{};
+            float total{0.0f};
+            for(std::size_t i{0uz}; i < durations.size(); ++i)
+            {
+                if( durations[i] )
+                {
+                    known.push_back({i, *durations[i]});
+                    total += *durations[i];
+                }
+                else
+                {
+                    unknown.push_back({i, 0.0f});
+                }
+            }
+            if( known.empty() )
+            {
+                return {};
+            }
+            const float average = total / static_cast<float>(known.size());
+            for(auto& i: unknown)
+            {
+                i.Cost = average;
+            }
+            std::ranges::stable_sort(known, std::ranges::greater{}, &ScheduledTask::Cost);
+            unknown.insert(unknown.end(), known.begin(), known.end());
+            return unknown;
+        }
+
+        /// Assign tasks in schedule order to bin which is least loaded so far. Returns bin of each task of schedule.
+        inline std::vector<std::size_t> PackLongestFirst(const std::vector<ScheduledTask>& schedule, const std::size_t binCount)
+        {
+            std::vector<float> load(binCount, 0.0f);
+            std::vector<std::size_t> bins{};
+            bins.reserve(schedule.size());
+            for(const auto& i: schedule)
+            {
+                const auto bin = static_cast<std::size_t>(std::ranges::min_element(load) - load.begin());
+                load[bin] += i.Cost;
+                bins.push_back(bin);
+            }
+            return bins;
+        }
+
+        inline std::string EscapeXml(const std::string_view text)
+        {
+            std::string result{};
+            result.reserve(text.size());
+            for(const char i: text)
+            {
+                switch(i)
+                {
+                case '&':
+                    result += "&amp;";
+                    break;
+                case '<':
+                    result += "&lt;";
+                    break;
+                case '>':
+                    result += "&gt;";
+                    break;
+                case '"':
+                    result += "&quot;";
+                    break;
+                case '\'':
+                    result += "&apos;";
+                    break;
+                default:
+                    // Control characters are not allowed in XML 1.0.
+                    if( static_cast<unsigned char>(i) >= 0x20u || i == '\n' || i == '\t' || i == '\r' )
+                    {
+                        result += i;
+                    }
+                    break;
+                }
+            }
+            return result;
+        }
+
+        inline std::string EscapeJson(const std::string_view text)
+        {
+            std::string result{};
+            result.reserve(text.size());
+            for(const char i: text)
+            {
+                switch(i)
+                {
+                case '"':
+                    result += "\\\"";
+                    break;
+                case '\\':
+                    result += "\\\\";
+                    break;
+                case '\n':
+                    result += "\\n";
+                    break;
+                case '\r':
+                    result += "\\r";
+                    break;
+                case '\t':
+                    result += "\\t";
+                    break;
+                default:
+                    if( static_cast<unsigned char>(i) < 0x20u )
+                    {
+                        result += std::format("\\u{:04x}", static_cast<unsigned int>(i));
+                    }
+                    else
+                    {
+                        result += i;
+                    }
+                    break;
+                }
+            }
+            return result;
+        }
+
+        template<IsPointerType T>
+        std::string FormatPointer(const T& pointer)
+        {
+            if constexpr(std::is_null_pointer_v<T>)
+            {
+                // Special std::nullptr_t type in this case just return null.
+                return "null";
+            }
+            else
+            {
+                // If pointer is nullptr then return null and if not convert pointer to string.
+                return pointer == nullptr ? "null" : std::format("{}", static_cast<const void*>(pointer));
+            }
+        }
+    }
+
+    class CTestAssertionException final: public std::runtime_error
+    {
+    public:
+        CTestAssertionException():
+            std::runtime_error("Test Assertion")
+        {
+        }
+    };
+
+    class CTestSkippedException final: public std::runtime_error
+    {
+    public:
+        CTestSkippedException():
+            std::runtime_error("Test Skipped")
+        {
+        }
+    };
+
+    /// Helper used to define custom near comparision
+    template<class T>
+    struct Approx;
+
+    template<class T, class E>
+    concept HasApproxDefined = requires(const T& value, const T& wanted, const E& epsilon)
+    {
+        {Approx<T>::IsNear(value, wanted, epsilon)} -> std::convertible_to<bool>;
+    };
+
+    template<class T, class E>
+    bool IsNear(const T& value, const T& wanted, const E& epsilon)
+    {
+        if constexpr( HasApproxDefined<T, E> )
+        {
+            return Approx<T>::IsNear(value, wanted, epsilon);
+        }
+        else
+        {
+            return std::abs(value - wanted) <= epsilon;
+        }
+    }
+
+    /// Relative tolerance of near checks, values are near when |value - wanted| <= Factor * max(|value|, |wanted|).
+    template<std::floating_point T>
+    struct Relative
+    {
+        T Factor{};
+    };
+
+    /// Tolerance of near checks in units in the last place, values are near when at most Count representable values are between them.
+    struct Ulps
+    {
+        std::uint64_t Count{0u};
+    };
+
+    template<std::floating_point T, class F>
+    bool IsNear(const T& value, const T& wanted, const Relative<F>& tolerance)
+    {
+        return std::abs(value - wanted) <= tolerance.Factor * std::max(std::abs(value), std::abs(wanted));
+    }
+
+    template<std::floating_point T> requires (std::numeric_limits<T>::is_iec559 && (sizeof(T) == 4uz || sizeof(T) == 8uz))
+    bool IsNear(const T& value, const T& wanted, const Ulps& tolerance)
+    {
+        using Bits = std::conditional_t<sizeof(T) == 4uz, std::uint32_t, std::uint64_t>;
+        if( std::isnan(value) || std::isnan(wanted) )
+        {
+            return false;
+        }
+        if( value == wanted )
+        {
+            return true;
+        }
+        // Map bits to unsigned line where neighbouring floats are neighbouring numbers, zeros of both signs meet in the middle.
+        const auto toLine = [](const T x)
+        {
+            const Bits bits = std::bit_cast<Bits>(x);
+            constexpr Bits SIGN = Bits{1u} << (sizeof(Bits) * 8uz - 1uz);
+            return (bits & SIGN) ? ~bits + 1u : bits | SIGN;
+        };
+        const Bits a = toLine(value);
+        const Bits b = toLine(wanted);
+        return static_cast<std::uint64_t>(a > b ? a - b : b - a) <= tolerance.Count;
+    }
+
+    /// Default epsilon
+    template<std::floating_point T>
+    inline constexpr T EPSILON = std::numeric_limits<T>::epsilon();
+
+    /// Small epsilon
+    template<std::floating_point T>
+    inline constexpr T EPSILON_SMALL = T{0.0001};
+
+    namespace Details
+    {
+        /// Instruction set used by comparison kernels of range checks.
+        enum class ESimdLevel
+        {
+            Scalar,
+            SSE2,
+            AVX2
+        };
+
+        inline ESimdLevel DetectSimdLevel()
+        {
+        #ifdef MTEST_X86_SIMD
+            #if defined(_MSC_VER)
+                std::array<int, 4uz> info{};
+                __cpuid(info.data(), 0);
+                if( info[0] >= 7 )
+                {
+                    __cpuid(info.data(), 1);
+                    const bool osSaves = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6u) == 6u;
+                    __cpuidex(info.data(), 7, 0);
+                    if( osSaves && (info[1] & (1 << 5)) != 0 )
+                    {
+                        return ESimdLevel::AVX2;
+                    }
+                }
+            #else
+                if( __builtin_cpu_supports("avx2") )
+                {
+                    return ESimdLevel::AVX2;
+                }
+            #endif
+            return ESimdLevel::SSE2;
+        #else
+            return ESimdLevel::Scalar;
+        #endif
+        }
+
+        /// Best instruction set of this processor, it is detected once.
+        inline ESimdLevel GetSimdLevel()
+        {
+            static const ESimdLevel level = DetectSimdLevel();
+            return level;
+        }
+
+        /// Element comparison done by float kernels, it matches IsNear with plain epsilon and Relative tolerance.
+        enum class EFloatCompare
+        {
+            Equal,
+            Absolute,
+            Relative
+        };
+
+        template<class T>
+        concept IsSimdFloat = std::same_as<T, float> || std::same_as<T, double>;
+
+        template<IsSimdFloat T>
+        bool FloatMatches(const T value, const T wanted, const EFloatCompare compare, const T tolerance)
+        {
+            switch( compare )
+            {
+            case EFloatCompare::Equal:
+                return value == wanted;
+            case EFloatCompare::Absolute:
+                return std::abs(value - wanted) <= tolerance;
+            case EFloatCompare::Relative:
+                return std::abs(value - wanted) <= tolerance * std::max(std::abs(value), std::abs(wanted));
+            }
+            return false;
+        }
+
+        template<IsSimdFloat T>
+        std::size_t FindFloatMismatchScalar(const T* value, const T* wanted, const std::size_t size, std::size_t start,
+            const EFloatCompare compare, const T tolerance)
+        {
+            for(; start < size; ++start)
+            {
+                if( !FloatMatches(value[start], wanted[start], compare, tolerance) )
+                {
+                    break;
+                }
+            }
+            return start;
+        }
+
+        inline std::size_t FindByteMismatchScalar(const std::byte* value, const std::byte* wanted, const std::size_t size, std::size_t start)
+        {
+            for(; start < size; ++start)
+            {
+                if( value[start] != wanted[start] )
+                {
+                    break;
+                }
+            }
+            return start;
+        }
+
+    #ifdef MTEST_X86_SIMD
+        inline std::size_t FindByteMismatchSSE2(const std::byte* value, const std::byte* wanted, const std::size_t size, std::size_t start)
+        {
+            for(; start + 16uz <= size; start += 16uz)
+            {
+                const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(value + start));
+                const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(wanted + start));
+                const auto equal = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)));
+                if( equal != 0xFFFFu )
+                {
+                    return start + static_cast<std::size_t>(std::countr_one(equal));
+                }
+            }
+            return FindByteMismatchScalar(value, wanted, size, start);
+        }
+
+        MTEST_INTERNAL_TARGET_AVX2 inline std::size_t FindByteMismatchAVX2(const std::byte* value, const std::byte* wanted, const std::size_t size,
+            std::size_t start)
+        {
+            for(; start + 32uz <= size; start += 32uz)
+            {
+                const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(value + start));
+                const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(wanted + start));
+                const auto equal = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b)));
+                if( equal != 0xFFFFFFFFu )
+                {
+                    return start + static_cast<std::size_t>(std::countr_one(equal));
+                }
+            }
+            return FindByteMismatchScalar(value, wanted, size, start);
+        }
+
+        /// Lanes of SSE2 registers for float and double, so one kernel template serves both.
+        template<IsSimdFloat T>
+        struct SSE2Lanes;
+
+        template<>
+        struct SSE2Lanes<float>
+        {
+            using Vector = __m128;
+            static constexpr std::size_t COUNT = 4uz;
+            static Vector Load(const float* data) { return _mm_loadu_ps(data); }
+            static Vector Set(const float value) { return _mm_set1_ps(value); }
+            static Vector Abs(const Vector value) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), value); }
+            static Vector Sub(const Vector a, const Vector b) { return _mm_sub_ps(a, b); }
+            static Vector Mul(const Vector a, const Vector b) { return _mm_mul_ps(a, b); }
+            static Vector Max(const Vector a, const Vector b) { return _mm_max_ps(a, b); }
+            static Vector Equal(const Vector a, const Vector b) { return _mm_cmpeq_ps(a, b); }
+            static Vector LessEqual(const Vector a, const Vector b) { return _mm_cmple_ps(a, b); }
+            static unsigned Mask(const Vector value) { return static_cast<unsigned>(_mm_movemask_ps(value)); }
+        };
+
+        template<>
+        struct SSE2Lanes<double>
+        {
+            using Vector = __m128d;
+            static constexpr std::size_t COUNT = 2uz;
+            static Vector Load(const double* data) { return _mm_loadu_pd(data); }
+            static Vector Set(const double value) { return _mm_set1_pd(value); }
+            static Vector Abs(const Vector value) { return _mm_andnot_pd(_mm_set1_pd(-0.0), value); }
+            static Vector Sub(const Vector a, const Vector b) { return _mm_sub_pd(a, b); }
+            static Vector Mul(const Vector a, const Vector b) { return _mm_mul_pd(a, b); }
+            static Vector Max(const Vector a, const Vector b) { return _mm_max_pd(a, b); }
+            static Vector Equal(const Vector a, const Vector b) { return _mm_cmpeq_pd(a, b); }
+            static Vector LessEqual(const Vector a, const Vector b) { return _mm_cmple_pd(a, b); }
+            static unsigned Mask(const Vector value) { return static_cast<unsigned>(_mm_movemask_pd(value)); }
+        };
+
+        /// Compare whole registers, lanes which do not match are found by mask. NaN never matches, same as in scalar comparison.
+        template<class Lanes, IsSimdFloat T>
+        std::size_t FindFloatMismatchSSE2(const T* value, const T* wanted, const std::size_t size, std::size_t start,
+            const EFloatCompare compare, const T tolerance)
+        {
+            constexpr unsigned ALL = (1u << Lanes::COUNT) - 1u;
+            const auto limit = Lanes::Set(tolerance);
+            for(; start + Lanes::COUNT <= size; start += Lanes::COUNT)
+            {
+                const auto a = Lanes::Load(value + start);
+                const auto b = Lanes::Load(wanted + start);
+                typename Lanes::Vector match{};
+                if( compare == EFloatCompare::Equal )
+                {
+                    match = Lanes::Equal(a, b);
+                }
+                else if( compare == EFloatCompare::Absolute )
+                {
+                    match = Lanes::LessEqual(Lanes::Abs(Lanes::Sub(a, b)), limit);
+                }
+                else
+                {
+                    match = Lanes::LessEqual(Lanes::Abs(Lanes::Sub(a, b)), Lanes::Mul(limit, Lanes::Max(Lanes::Abs(a), Lanes::Abs(b))));
+                }
+                const unsigned mask = Lanes::Mask(match);
+                if( mask != ALL )
+                {
+                    return start + static_cast<std::size_t>(std::countr_one(mask));
+                }
+            }
+            return FindFloatMismatchScalar(value, wanted, size, start, compare, tolerance);
+        }
+
+        MTEST_INTERNAL_TARGET_AVX2 inline std::size_t FindFloatMismatchAVX2(const float* value, const float* wanted, const std::size_t size,
+            std::size_t start, const EFloatCompare compare, const float tolerance)
+        {
+            const __m256 sign = _mm256_set1_ps(-0.0f);
+            const __m256 limit = _mm256_set1_ps(tolerance);
+            for(; start + 8uz <= size; start += 8uz)
+            {
+                const __m256 a = _mm256_loadu_ps(value + start);
+                const __m256 b = _mm256_loadu_ps(wanted + start);
+                const __m256 difference = _mm256_andnot_ps(sign, _mm256_sub_ps(a, b));
+                __m256 match{};
+                if( compare == EFloatCompare::Equal )
+                {
+                    match = _mm256_cmp_ps(a, b, _CMP_EQ_OQ);
+                }
+                else if( compare == EFloatCompare::Absolute )
+                {
+                    match = _mm256_cmp_ps(difference, limit, _CMP_LE_OQ);
+                }
+                else
+                {
+                    const __m256 scale = _mm256_max_ps(_mm256_andnot_ps(sign, a), _mm256_andnot_ps(sign, b));
+                    match = _mm256_cmp_ps(difference, _mm256_mul_ps(limit, scale), _CMP_LE_OQ);
+                }
+                const auto mask = static_cast<unsigned>(_mm256_movemask_ps(match));
+                if( mask != 0xFFu )
+                {
+                    return start + static_cast<std::size_t>(std::countr_one(mask));
+                }
+            }
+            return FindFloatMismatchScalar(value, wanted, size, start, compare, tolerance);
+        }
+
+        MTEST_INTERNAL_TARGET_AVX2 inline std::size_t FindFloatMismatchAVX2(const double* value, const double* wanted, const std::size_t size,
+            std::size_t start, const EFloatCompare compare, const double tolerance)
+        {
+            const __m256d sign = _mm256_set1_pd(-0.0);
+            const __m256d limit = _mm256_set1_pd(tolerance);
+            for(; start + 4uz <= size; start += 4uz)
+            {
+                const __m256d a = _mm256_loadu_pd(value + start);
+                const __m256d b = _mm256_loadu_pd(wanted + start);
+                const __m256d difference = _mm256_andnot_pd(sign, _mm256_sub_pd(a, b));
+                __m256d match{};
+                if( compare == EFloatCompare::Equal )
+                {
+                    match = _mm256_cmp_pd(a, b, _CMP_EQ_OQ);
+                }
+                else if( compare == EFloatCompare::Absolute )
+                {
+                    match = _mm256_cmp_pd(difference, limit, _CMP_LE_OQ);
+                }
+                else
+                {
+                    const __m256d scale = _mm256_max_pd(_mm256_andnot_pd(sign, a), _mm256_andnot_pd(sign, b));
+                    match = _mm256_cmp_pd(difference, _mm256_mul_pd(limit, scale), _CMP_LE_OQ);
+                }
+                const auto mask = static_cast<unsigned>(_mm256_movemask_pd(match));
+                if( mask != 0xFu )
+                {
+                    return start + static_cast<std::size_t>(std::countr_one(mask));
+                }
+            }
+            return FindFloatMismatchScalar(value, wanted, size, start, compare, tolerance);
+        }
+    #endif
+
+        /// Index of first byte from start which differs, or size when all are same.
+        inline std::size_t FindByteMismatch(const std::byte* value, const std::byte* wanted, const std::size_t size, const std::size_t start)
+        {
+        #ifdef MTEST_X86_SIMD
+            if( GetSimdLevel() == ESimdLevel::AVX2 )
+            {
+                return FindByteMismatchAVX2(value, wanted, size, start);
+            }
+            return FindByteMismatchSSE2(value, wanted, size, start);
+        #else
+            return FindByteMismatchScalar(value, wanted, size, start);
+        #endif
+        }
+
+        /// Index of first element from start which does not match, or size when all match.
+        template<IsSimdFloat T>
+        std::size_t FindFloatMismatch(const T* value, const T* wanted, const std::size_t size, const std::size_t start,
+            const EFloatCompare compare, const T tolerance)
+        {
+        #ifdef MTEST_X86_SIMD
+            if( GetSimdLevel() == ESimdLevel::AVX2 )
+            {
+                return FindFloatMismatchAVX2(value, wanted, size, start, compare, tolerance);
+            }
+            return FindFloatMismatchSSE2<SSE2Lanes<T>>(value, wanted, size, start, compare, tolerance);
+        #else
+            return FindFloatMismatchScalar(value, wanted, size, start, compare, tolerance);
+        #endif
+        }
+
+        /// Largest T which is not greater than tolerance, so comparison in T gives same result as IsNear which compares in type of tolerance.
+        template<IsSimdFloat T, class E>
+        T ToleranceAs(const E tolerance)
+        {
+            T result = static_cast<T>(tolerance);
+            if constexpr( std::floating_point<E> && sizeof(E) > sizeof(T) )
+            {
+                if( static_cast<E>(result) > tolerance )
+                {
+                    result = std::nextafter(result, -std::numeric_limits<T>::infinity());
+                }
+            }
+            return result;
+        }
+
+        template<class R>
+        decltype(auto) ElementAt(const R& range, const std::size_t index)
+        {
+            return std::ranges::begin(range)[static_cast<std::ranges::range_difference_t<const R>>(index)];
+        }
+
+        /// Elements which are compared by bytes, their equality is equality of their bytes.
+        template<class T>
+        concept IsBytewiseComparable = std::is_integral_v<T> || std::is_enum_v<T> || std::is_pointer_v<T>;
+
+        /// Index of first element from start which is not equal, or size when all are equal.
+        template<class R, class W>
+        std::size_t FindUnequal(const R& value, const W& wanted, const std::size_t size, std::size_t start)
+        {
+            using T = std::ranges::range_value_t<R>;
+            if constexpr( std::ranges::contiguous_range<const R> && std::ranges::contiguous_range<const W> &&
+                std::same_as<T, std::ranges::range_value_t<W>> )
+            {
+                if constexpr( IsSimdFloat<T> )
+                {
+                    return FindFloatMismatch(std::ranges::data(value), std::ranges::data(wanted), size, start, EFloatCompare::Equal, T{});
+                }
+                else if constexpr( IsBytewiseComparable<T> )
+                {
+                    const std::size_t byte = FindByteMismatch(reinterpret_cast<const std::byte*>(std::ranges::data(value)),
+                        reinterpret_cast<const std::byte*>(std::ranges::data(wanted)), size * sizeof(T), start * sizeof(T));
+                    return byte / sizeof(T);
+                }
+            }
+            for(; start < size; ++start)
+            {
+                if( !(ElementAt(value, start) == ElementAt(wanted, start)) )
+                {
+                    break;
+                }
+            }
+            return start;
+        }
+
+        /// Index of first element from start which is not near, or size when all are near. Types with Approx are compared by it.
+        template<class R, class W, class E>
+        std::size_t FindNotNear(const R& value, const W& wanted, const E& tolerance, const std::size_t size, std::size_t start)
+        {
+            using T = std::ranges::range_value_t<R>;
+            if constexpr( std::ranges::contiguous_range<const R> && std::ranges::contiguous_range<const W> && IsSimdFloat<T> &&
+                !HasApproxDefined<T, E> )
+            {
+                if constexpr( std::is_arithmetic_v<E> )
+                {
+                    return FindFloatMismatch(std::ranges::data(value), std::ranges::data(wanted), size, start, EFloatCompare::Absolute,
+                        ToleranceAs<T>(tolerance));
+                }
+                else if constexpr( std::same_as<E, Relative<T>> )
+                {
+                    return FindFloatMismatch(std::ranges::data(value), std::ranges::data(wanted), size, start, EFloatCompare::Relative,
+                        tolerance.Factor);
+                }
+            }
+            for(; start < size; ++start)
+            {
+                if( !IsNear<T>(ElementAt(value, start), ElementAt(wanted, start), tolerance) )
+                {
+                    break;
+                }
+            }
+            return start;
+        }
+
+        /// Position of first mismatch and number of all mismatches, counting is done only when check fails.
+        struct RangeMismatches
+        {
+            std::size_t First{0uz};
+            std::size_t Count{0uz};
+        };
+
+        template<IsInvocable<std::size_t, std::size_t> Find>
+        std::optional<RangeMismatches> FindMismatches(const std::size_t size, Find find)
+        {
+            RangeMismatches result{find(0uz), 0uz};
+            if( result.First >= size ) [[likely]]
+            {
+                return std::nullopt;
+            }
+            for(std::size_t i = result.First; i < size; i = find(i + 1uz))
+            {
+                ++result.Count;
+            }
+            return result;
+        }
+
+        /// Elements shown on each side of first mismatch.
+        constexpr std::size_t RANGE_CONTEXT = 3uz;
+
+        template<class T>
+        std::string FormatElement(const T& value)
+        {
+            if constexpr( std::same_as<T, std::byte> )
+            {
+                return std::format("0x{:02x}", std::to_integer<unsigned>(value));
+            }
+            else if constexpr( IsEnumeration<T> )
+            {
+                return std::format("{}", std::to_underlying(value));
+            }
+            else if constexpr( IsPointerType<T> )
+            {
+                return FormatPointer(value);
+            }
+            else
+            {
+                return std::format("{}", value);
+            }
+        }
+
+        template<class R>
+        std::string FormatWindow(const R& range, const std::size_t first, const std::size_t last)
+        {
+            std::string result{"{"};
+            for(std::size_t i = first; i < last; ++i)
+            {
+                result += (i > first ? ", " : "") + FormatElement(ElementAt(range, i));
+            }
+            return result + "}";
+        }
+
+        /// Description of first mismatch with elements around it, bytes are described by offset.
+        template<class R, class W>
+        std::string FormatMismatches(const std::string_view message, const R& value, const W& wanted, const std::size_t size,
+            const RangeMismatches& mismatches)
+        {
+            constexpr bool BYTES = std::same_as<std::ranges::range_value_t<R>, std::byte>;
+            const std::size_t first = mismatches.First - std::min(mismatches.First, RANGE_CONTEXT);
+            const std::size_t last = std::min(mismatches.First + RANGE_CONTEXT + 1uz, size);
+            return std::format("{} '{}' differs in {} of {} {}, first mismatch at {} {}: '{}' should be '{}', context [{}, {}) is {} but should be {}",
+                BYTES ? "Bytes" : "Range", message, mismatches.Count, size, BYTES ? "bytes" : "elements", BYTES ? "offset" : "index",
+                mismatches.First, FormatElement(ElementAt(value, mismatches.First)), FormatElement(ElementAt(wanted, mismatches.First)), first, last, FormatWindow(value, first, last), FormatWindow(wanted, first, last));
+        }
+
+        /// Tolerance of near check as text.
+        template<class E>
+        std::string FormatTolerance(const E& tolerance)
+        {
+            return std::format("delta '{}'", tolerance);
+        }
+
+        template<class F>
+        std::string FormatTolerance(const Relative<F>& tolerance)
+        {
+            return std::format("relative tolerance '{}'", tolerance.Factor);
+        }
+
+        inline std::string FormatTolerance(const Ulps& tolerance)
+        {
+            return std::format("tolerance '{}' ulps", tolerance.Count);
+        }
+
+        /// Strings and ranges shorter than these are shown whole when equality check fails, longer or multiline ones are shown as diff.
+        constexpr std::size_t DIFF_MIN_LENGTH = 80uz;
+        constexpr std::size_t DIFF_MIN_ELEMENTS = 16uz;
+        /// Unchanged lines or elements shown around each change, single line strings show characters.
+        constexpr std::size_t DIFF_CONTEXT = 3uz;
+        constexpr std::size_t DIFF_CONTEXT_CHARACTERS = 24uz;
+        /// Limits of diff output, longer lines are cut and hunks after last line are only counted.
+        constexpr std::size_t DIFF_MAX_LINES = 100uz;
+        constexpr std::size_t DIFF_MAX_LINE_LENGTH = 200uz;
+        /// Cost of diff grows with number of edits and length of differing part, values which need more are not diffed.
+        constexpr std::size_t DIFF_MAX_EDITS = 4000uz;
+        constexpr std::size_t DIFF_MAX_LENGTH = 1'000'000uz;
+
+        /// Elements [A, A + Removed) of value are replaced by elements [B, B + Added) of wanted.
+        struct DiffChange
+        {
+            std::size_t A{0uz};
+            std::size_t Removed{0uz};
+            std::size_t B{0uz};
+            std::size_t Added{0uz};
+        };
+
+        /// Linear space Myers diff, it splits sequences at middle of shortest edit script and marks elements which are not in common subsequence.
+        /// Common prefix and suffix are skipped before anything is allocated, memory depends only on length of differing part and DIFF_MAX_EDITS.
+        template<IsInvocable<bool, std::size_t, std::size_t> Equal>
+        class CMyersDiff
+        {
+            /// Searched diagonals are at most this far from middle diagonal of each search.
+            static constexpr std::ptrdiff_t DIAGONALS = static_cast<std::ptrdiff_t>(DIFF_MAX_EDITS / 2uz) + 3;
+        public:
+            CMyersDiff(const std::size_t aSize, const std::size_t bSize, Equal equal):
+                ASize(aSize),
+                BSize(bSize),
+                AreEqual(equal)
+            {
+            }
+
+            /// Changes in order, or nullopt when sequences need more than DIFF_MAX_EDITS edits or differ in more than DIFF_MAX_LENGTH elements.
+            std::optional<std::vector<DiffChange>> Run()
+            {
+                std::size_t prefix = 0uz;
+                for(; prefix < std::min(ASize, BSize) && AreEqual(prefix, prefix); ++prefix)
+                {
+                }
+                std::size_t suffix = 0uz;
+                for(; suffix < std::min(ASize, BSize) - prefix && AreEqual(ASize - 1uz - suffix, BSize - 1uz - suffix); ++suffix)
+                {
+                }
+                const std::size_t aCount = ASize - prefix - suffix;
+                const std::size_t bCount = BSize - prefix - suffix;
+                // Every element over length of other sequence is an edit.
+                if( std::max(aCount, bCount) - std::min(aCount, bCount) > DIFF_MAX_EDITS || aCount + bCount > DIFF_MAX_LENGTH )
+                {
+                    return std::nullopt;
+                }
+                Prefix = static_cast<std::ptrdiff_t>(prefix);
+                Removed.assign(aCount, false);
+                Added.assign(bCount, false);
+                Forward.assign(static_cast<std::size_t>(DIAGONALS) * 2uz + 1uz, 0);
+                Backward.assign(static_cast<std::size_t>(DIAGONALS) * 2uz + 1uz, 0);
+                if( !Compare(Prefix, Prefix + static_cast<std::ptrdiff_t>(aCount), Prefix, Prefix + static_cast<std::ptrdiff_t>(bCount)) )
+                {
+                    return std::nullopt;
+                }
+                std::vector<DiffChange> changes{};
+                std::size_t a = 0uz;
+                std::size_t b = 0uz;
+                while( a < aCount || b < bCount )
+                {
+                    if( a < aCount && b < bCount && !Removed[a] && !Added[b] )
+                    {
+                        ++a;
+                        ++b;
+                        continue;
+                    }
+                    DiffChange change{prefix + a, 0uz, prefix + b, 0uz};
+                    for(; a < aCount && Removed[a]; ++a)
+                    {
+                        ++change.Removed;
+                    }
+                    for(; b < bCount && Added[b]; ++b)
+                    {
+                        ++change.Added;
+                    }
+                    changes.push_back(change);
+                }
+                return changes;
+            }
+
+        private:
+            bool Equals(const std::ptrdiff_t a, const std::ptrdiff_t b)
+            {
+                return AreEqual(static_cast<std::size_t>(a), static_cast<std::size_t>(b));
+            }
+
+            std::ptrdiff_t& ForwardAt(const std::ptrdiff_t diagonal)
+            {
+                return Forward[static_cast<std::size_t>(diagonal - ForwardMiddle + DIAGONALS)];
+            }
+
+            std::ptrdiff_t& BackwardAt(const std::ptrdiff_t diagonal)
+            {
+                return Backward[static_cast<std::size_t>(diagonal - BackwardMiddle + DIAGONALS)];
+            }
+
+            bool Compare(std::ptrdiff_t aBegin, std::ptrdiff_t aEnd, std::ptrdiff_t bBegin, std::ptrdiff_t bEnd)
+            {
+                for(; aBegin < aEnd && bBegin < bEnd && Equals(aBegin, bBegin); ++aBegin, ++bBegin)
+                {
+                }
+                for(; aBegin < aEnd && bBegin < bEnd && Equals(aEnd - 1, bEnd - 1); --aEnd, --bEnd)
+                {
+                }
+                if( aBegin == aEnd || bBegin == bEnd )
+                {
+                    std::fill(Removed.begin() + (aBegin - Prefix), Removed.begin() + (aEnd - Prefix), true);
+                    std::fill(Added.begin() + (bBegin - Prefix), Added.begin() + (bEnd - Prefix), true);
+                    return true;
+                }
+                const auto middle = FindMiddle(aBegin, aEnd, bBegin, bEnd);
+                if( !middle )
+                {
+                    return false;
+                }
+                return Compare(aBegin, middle->first, bBegin, middle->second) && Compare(middle->first, aEnd, middle->second, bEnd);
+            }
+
+            /// Point on shortest edit script with half of edits before it, searched from both ends at once on diagonals x - y.
+            std::optional<std::pair<std::ptrdiff_t, std::ptrdiff_t>> FindMiddle(const std::ptrdiff_t aBegin, const std::ptrdiff_t aEnd,
+                const std::ptrdiff_t bBegin, const std::ptrdiff_t bEnd)
+            {
+                const std::ptrdiff_t lowest = aBegin - bEnd;
+                const std::ptrdiff_t highest = aEnd - bBegin;
+                ForwardMiddle = aBegin - bBegin;
+                BackwardMiddle = aEnd - bEnd;
+                const bool odd = ((ForwardMiddle - BackwardMiddle) & 1) != 0;
+                std::ptrdiff_t forwardLow = ForwardMiddle;
+                std::ptrdiff_t forwardHigh = ForwardMiddle;
+                std::ptrdiff_t backwardLow = BackwardMiddle;
+                std::ptrdiff_t backwardHigh = BackwardMiddle;
+                ForwardAt(ForwardMiddle) = aBegin;
+                BackwardAt(BackwardMiddle) = aEnd;
+                for(std::size_t edits = 1uz; edits <= DIFF_MAX_EDITS / 2uz + 1uz; ++edits)
+                {
+                    // Diagonals next to searched ones are marked as unreached, search does not leave sequences.
+                    if( forwardLow > lowest )
+                    {
+                        ForwardAt(--forwardLow - 1) = -1;
+                    }
+                    else
+                    {
+                        ++forwardLow;
+                    }
+                    if( forwardHigh < highest )
+                    {
+                        ForwardAt(++forwardHigh + 1) = -1;
+                    }
+                    else
+                    {
+                        --forwardHigh;
+                    }
+                    for(std::ptrdiff_t diagonal = forwardHigh; diagonal >= forwardLow; diagonal -= 2)
+                    {
+                        const std::ptrdiff_t low = ForwardAt(diagonal - 1);
+                        const std::ptrdiff_t high = ForwardAt(diagonal + 1);
+                        std::ptrdiff_t a = low < high ? high : low + 1;
+                        std::ptrdiff_t b = a - diagonal;
+                        for(; a < aEnd && b < bEnd && Equals(a, b); ++a, ++b)
+                        {
+                        }
+                        ForwardAt(diagonal) = a;
+                        if( odd && backwardLow <= diagonal && diagonal <= backwardHigh && BackwardAt(diagonal) <= a )
+                        {
+                            return std::pair{a, b};
+                        }
+                    }
+                    constexpr std::ptrdiff_t NONE = std::numeric_limits<std::ptrdiff_t>::max();
+                    if( backwardLow > lowest )
+                    {
+                        BackwardAt(--backwardLow - 1) = NONE;
+                    }
+                    else
+                    {
+                        ++backwardLow;
+                    }
+                    if( backwardHigh < highest )
+                    {
+                        BackwardAt(++backwardHigh + 1) = NONE;
+                    }
+                    else
+                    {
+                        --backwardHigh;
+                    }
+                    for(std::ptrdiff_t diagonal = backwardHigh; diagonal >= backwardLow; diagonal -= 2)
+                    {
+                        const std::ptrdiff_t low = BackwardAt(diagonal - 1);
+                        const std::ptrdiff_t high = BackwardAt(diagonal + 1);
+                        std::ptrdiff_t a = low < high ? low : high - 1;
+                        std::ptrdiff_t b = a - diagonal;
+                        for(; aBegin < a && bBegin < b && Equals(a - 1, b - 1); --a, --b)
+                        {
+                        }
+                        BackwardAt(diagonal) = a;
+                        if( !odd && forwardLow <= diagonal && diagonal <= forwardHigh && a <= ForwardAt(diagonal) )
+                        {
+                            return std::pair{a, b};
+                        }
+                    }
+                }
+                return std::nullopt;
+            }
+
+            std::size_t ASize{0uz};
+            std::size_t BSize{0uz};
+            Equal AreEqual;
+            std::ptrdiff_t Prefix{0};
+            std::vector<bool> Removed{};
+            std::vector<bool> Added{};
+            std::vector<std::ptrdiff_t> Forward{};
+            std::vector<std::ptrdiff_t> Backward{};
+            std::ptrdiff_t ForwardMiddle{0};
+            std::ptrdiff_t BackwardMiddle{0};
+        };
+
+        /// Changes which are closer than two contexts are shown in one hunk.
+        struct DiffHunk
+        {
+            std::size_t ABegin{0uz};
+            std::size_t AEnd{0uz};
+            std::size_t BBegin{0uz};
+            std::size_t BEnd{0uz};
+            std::size_t FirstChange{0uz};
+            std::size_t LastChange{0uz};
+        };
+
+        inline std::vector<DiffHunk> GroupDiffChanges(const std::vector<DiffChange>& changes, const std::size_t aSize, const std::size_t bSize,
+            const std::size_t context)
+        {
+            std::vector<DiffHunk> hunks{};
+            for(std::size_t i = 0uz; i < changes.size(); ++i)
+            {
+                const DiffChange& change = changes[i];
+                if( hunks.empty() || change.A > hunks.back().AEnd + context )
+                {
+                    const std::size_t before = std::min(change.A, context);
+                    hunks.push_back({change.A - before, 0uz, change.B - before, 0uz, i, 0uz});
+                }
+                DiffHunk& hunk = hunks.back();
+                const std::size_t after = std::min({context, aSize - change.A - change.Removed, bSize - change.B - change.Added});
+                hunk.AEnd = change.A + change.Removed + after;
+                hunk.BEnd = change.B + change.Added + after;
+                hunk.LastChange = i + 1uz;
+            }
+            return hunks;
+        }
+
+        inline std::string FormatDiffLine(const char prefix, const std::string_view text)
+        {
+            if( text.size() > DIFF_MAX_LINE_LENGTH )
+            {
+                return std::format("{}{}...", prefix, text.substr(0uz, DIFF_MAX_LINE_LENGTH));
+            }
+            return std::format("{}{}", prefix, text);
+        }
+
+        /// Hunks of unified diff, each element is written as one line. Output is cut after DIFF_MAX_LINES lines.
+        template<IsInvocable<std::string, std::size_t> LineA, IsInvocable<std::string, std::size_t> LineB>
+        std::string FormatLineDiff(const std::vector<DiffChange>& changes, const std::size_t aSize, const std::size_t bSize, LineA lineA, LineB lineB)
+        {
+            std::string result{};
+            std::size_t lines = 0uz;
+            // Lines after limit are only counted, they are not formatted.
+            const auto append = [&](const char prefix, const auto& line, const std::size_t index)
+            {
+                if( lines < DIFF_MAX_LINES )
+                {
+                    result += "\n" + FormatDiffLine(prefix, line(index));
+                }
+                ++lines;
+            };
+            for(const DiffHunk& hunk: GroupDiffChanges(changes, aSize, bSize, DIFF_CONTEXT))
+            {
+                append('@', [&](const std::size_t) { return std::format("@ -{},{} +{},{} @@", hunk.ABegin + 1uz, hunk.AEnd - hunk.ABegin,
+                    hunk.BBegin + 1uz, hunk.BEnd - hunk.BBegin); }, 0uz);
+                std::size_t a = hunk.ABegin;
+                for(std::size_t i = hunk.FirstChange; i < hunk.LastChange; ++i)
+                {
+                    const DiffChange& change = changes[i];
+                    for(; a < change.A; ++a)
+                    {
+                        append(' ', lineA, a);
+                    }
+                    for(; a < change.A + change.Removed; ++a)
+                    {
+                        append('-', lineA, a);
+                    }
+                    for(std::size_t b = change.B; b < change.B + change.Added; ++b)
+                    {
+                        append('+', lineB, b);
+                    }
+                }
+                for(; a < hunk.AEnd; ++a)
+                {
+                    append(' ', lineA, a);
+                }
+            }
+            if( lines > DIFF_MAX_LINES )
+            {
+                result += std::format("\n... {} more lines", lines - DIFF_MAX_LINES);
+            }
+            return result;
+        }
+
+        /// Hunks of single line strings, each hunk is written as removed and added part with few characters around.
+        inline std::string FormatInlineDiff(const std::vector<DiffChange>& changes, const std::string_view value, const std::string_view wanted)
+        {
+            const auto hunks = GroupDiffChanges(changes, value.size(), wanted.size(), DIFF_CONTEXT_CHARACTERS);
+            std::string result{};
+            for(std::size_t i = 0uz; i < hunks.size(); ++i)
+            {
+                if( i * 3uz >= DIFF_MAX_LINES )
+                {
+                    result += std::format("\n... {} more hunks", hunks.size() - i);
+                    break;
+                }
+                const DiffHunk& hunk = hunks[i];
+                result += std::format("\n@@ -{},{} +{},{} @@\n{}\n{}", hunk.ABegin + 1uz, hunk.AEnd - hunk.ABegin, hunk.BBegin + 1uz,
+                    hunk.BEnd - hunk.BBegin, FormatDiffLine('-', value.substr(hunk.ABegin, hunk.AEnd - hunk.ABegin)),
+                    FormatDiffLine('+', wanted.substr(hunk.BBegin, hunk.BEnd - hunk.BBegin)));
+            }
+            return result;
+        }
+
+        inline std::vector<std::string_view> SplitLines(const std::string_view text)
+        {
+            std::vector<std::string_view> lines{};
+            std::size_t begin = 0uz;
+            for(std::size_t end = text.find('\n'); end != std::string_view::npos; end = text.find('\n', begin))
+            {
+                lines.push_back(text.substr(begin, end - begin));
+                begin = end + 1uz;
+            }
+            lines.push_back(text.substr(begin));
+            return lines;
+        }
+
+        /// Diff of strings by lines, or by characters when both are single line. Short strings are not diffed.
+        inline std::optional<std::string> FormatStringDiff(const std::string_view value, const std::string_view wanted)
+        {
+            const bool multiline = value.contains('\n') || wanted.contains('\n');
+            if( !multiline && value.size() < DIFF_MIN_LENGTH && wanted.size() < DIFF_MIN_LENGTH )
+            {
+                return std::nullopt;
+            }
+            if( multiline )
+            {
+                const auto valueLines = SplitLines(value);
+                const auto wantedLines = SplitLines(wanted);
+                const auto changes = CMyersDiff{valueLines.size(), wantedLines.size(), [&](const std::size_t a, const std::size_t b)
+                {
+                    return valueLines[a] == wantedLines[b];
+                }}.Run();
+                if( !changes )
+                {
+                    const auto first = std::ranges::mismatch(valueLines, wantedLines).in1 - valueLines.begin();
+                    return std::format("values are too different to diff, first difference is at line {}", first + 1);
+                }
+                if( changes->empty() )
+                {
+                    return std::nullopt;
+                }
+                return std::format("diff of {} and {} lines (-value +wanted):{}", valueLines.size(), wantedLines.size(),
+                    FormatLineDiff(*changes, valueLines.size(), wantedLines.size(), [&](const std::size_t i) { return std::string{valueLines[i]}; },
+                        [&](const std::size_t i) { return std::string{wantedLines[i]}; }));
+            }
+            const auto changes = CMyersDiff{value.size(), wanted.size(), [&](const std::size_t a, const std::size_t b)
+            {
+                return value[a] == wanted[b];
+            }}.Run();
+            if( !changes )
+            {
+                const auto first = std::ranges::mismatch(value, wanted).in1 - value.begin();
+                return std::format("values are too different to diff, first difference is at character {}", first + 1);
+            }
+            if( changes->empty() )
+            {
+                return std::nullopt;
+            }
+            return std::format("diff of {} and {} characters (-value +wanted):{}", value.size(), wanted.size(),
+                FormatInlineDiff(*changes, value, wanted));
+        }
+
+        /// Ranges which are diffed element by element, each element is written as one line.
+        template<class T, class U>
+        concept IsDiffableRange = std::ranges::random_access_range<const T> && std::ranges::sized_range<const T> &&
+            std::ranges::random_access_range<const U> && std::ranges::sized_range<const U> &&
+            requires(std::ranges::range_reference_t<const T> value, std::ranges::range_reference_t<const U> wanted)
+            {
+                {value == wanted} -> std::convertible_to<bool>;
+            };
+
+        template<class T, class U>
+        std::optional<std::string> FormatRangeDiff(const T& value, const U& wanted)
+        {
+            const auto valueSize = static_cast<std::size_t>(std::ranges::size(value));
+            const auto wantedSize = static_cast<std::size_t>(std::ranges::size(wanted));
+            if( valueSize < DIFF_MIN_ELEMENTS && wantedSize < DIFF_MIN_ELEMENTS )
+            {
+                return std::nullopt;
+            }
+            const auto changes = CMyersDiff{valueSize, wantedSize, [&](const std::size_t a, const std::size_t b)
+            {
+                return static_cast<bool>(ElementAt(value, a) == ElementAt(wanted, b));
+            }}.Run();
+            if( !changes )
+            {
+                std::size_t first = 0uz;
+                for(; first < std::min(valueSize, wantedSize) && ElementAt(value, first) == ElementAt(wanted, first); ++first)
+                {
+                }
+                return std::format("values are too different to diff, first difference is at index {}", first);
+            }
+            if( changes->empty() )
+            {
+                return std::nullopt;
+            }
+            return std::format("diff of {} and {} elements (-value +wanted):{}", valueSize, wantedSize,
+                FormatLineDiff(*changes, valueSize, wantedSize, [&](const std::size_t i) { return FormatElement(ElementAt(value, i)); },
+                    [&](const std::size_t i) { return FormatElement(ElementAt(wanted, i)); }));
+        }
+
+        template<class R>
+        std::string FormatRange(const R& range)
+        {
+            const std::string elements = FormatWindow(range, 0uz, static_cast<std::size_t>(std::ranges::size(range)));
+            return std::format("[{}]", std::string_view{elements}.substr(1uz, elements.size() - 2uz));
+        }
+
+        template<class T>
+        bool IsNullPointer(const T& value)
+        {
+            if constexpr( std::is_pointer_v<T> )
+            {
+                return value == nullptr;
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        /// Message of failed equality check, large strings and ranges are shown as diff which is computed only here.
+        template<class T, class U>
+        std::string FormatInequality(const std::string_view message, const T& value, const U& wanted)
+        {
+            if constexpr( std::convertible_to<const T&, std::string_view> && std::convertible_to<const U&, std::string_view> )
+            {
+                if( !IsNullPointer(value) && !IsNullPointer(wanted) )
+                {
+                    if( const auto diff = FormatStringDiff(value, wanted); diff )
+                    {
+                        return std::format("Value '{}' is not equal to wanted value, {}", message, *diff);
+                    }
+                }
+                return std::format("Value '{}' is '{}' but should be '{}'", message, value, wanted);
+            }
+            else if constexpr( IsDiffableRange<T, U> )
+            {
+                if( const auto diff = FormatRangeDiff(value, wanted); diff )
+                {
+                    return std::format("Value '{}' is not equal to wanted value, {}", message, *diff);
+                }
+                // Elements are formatted one by one, so range itself does not need formatter.
+                return std::format("Value '{}' is '{}' but should be '{}'", message, FormatRange(value), FormatRange(wanted));
+            }
+            else
+            {
+                return std::format("Value '{}' is '{}' but should be '{}'", message, value, wanted);
+            }
+        }
+    }
+
+    /// User defined check result
+    using CheckResult = std::optional<std::string>;
+    /// Call to pass check
+    inline CheckResult CheckSuccess()
+    {
+        return std::nullopt;
+    }
+    /// Call to fail check
+    template<class...Args>
+    CheckResult CheckFailure(const std::format_string<Args...> fmt, Args&&...args)
+    {
+        return std::format(fmt, std::forward<Args>(args)...);
+    }
+
+    namespace Details
+    {
+        /// Writes plain values and strings to byte buffer, used to pass test results between processes.
+        class CBinaryWriter final
+        {
+        public:
+            template<class T> requires std::is_trivially_copyable_v<T>
+            void Write(const T& value)
+            {
+                Data.append(reinterpret_cast<const char*>(&value), sizeof(T));
+            }
+
+            void Write(const std::string& value)
+            {
+                Write<std::uint64_t>(value.size());
+                Data.append(value);
+            }
+
+            const std::string& GetData() const { return Data; }
+        private:
+            std::string Data{};
+        };
+
+        /// Reads data written by CBinaryWriter, throws when data is truncated.
+        class CBinaryReader final
+        {
+        public:
+            explicit CBinaryReader(const std::string_view data):
+                Data(data)
+            {
+            }
+
+            template<class T> requires std::is_trivially_copyable_v<T>
+            T Read()
+            {
+                T value{};
+                std::memcpy(&value, Take(sizeof(T)).data(), sizeof(T));
+                return value;
+            }
+
+            std::string ReadString()
+            {
+                const auto size = Read<std::uint64_t>();
+                return std::string{Take(static_cast<std::size_t>(size))};
+            }
+        private:
+            std::string_view Take(const std::size_t size)
+            {
+                if( Data.size() - Position < size )
+                {
+                    throw std::runtime_error("Truncated test result data");
+                }
+                const auto result = Data.substr(Position, size);
+                Position += size;
+                return result;
+            }
+        private:
+            std::string_view Data{};
+            std::size_t Position{0uz};
+        };
+    }
+
+    class CTestCase;
+
+    namespace Details
+    {
+        /// Test case run by calling thread.
+        constinit inline thread_local CTestCase* ActiveTest{nullptr};
+        constexpr std::size_t NO_THREAD = std::numeric_limits<std::size_t>::max();
+        /// Index of MTEST_CONCURRENT thread which runs on calling thread, its failures are marked with it.
+        constinit inline thread_local std::size_t ActiveThread{NO_THREAD};
+    }
+
+    /// Prevent compiler from optimizing away computation of value in benchmark.
+    template<class T>
+    inline void DoNotOptimize(const T& value)
+    {
+    #if defined(__GNUC__)
+        asm volatile("" : : "r,m"(value) : "memory");
+    #else
+        static_cast<void>(*static_cast<const volatile char*>(static_cast<const volatile void*>(&value)));
+    #endif
+    }
+
+    /// Prevent compiler from optimizing away computation of value in benchmark, value may be modified.
+    template<class T>
+    inline void DoNotOptimize(T& value)
+    {
+    #if defined(__GNUC__)
+        if constexpr( std::is_trivially_copyable_v<T> && sizeof(T) <= sizeof(void*) )
+        {
+            asm volatile("" : "+r,m"(value) : : "memory");
+        }
+        else
+        {
+            asm volatile("" : "+m"(value) : : "memory");
+        }
+    #else
+        static_cast<void>(*static_cast<volatile char*>(static_cast<volatile void*>(&value)));
+    #endif
+    }
+
+    /// Force all pending memory writes to be done before this point in benchmark.
+    inline void ClobberMemory()
+    {
+    #if defined(__GNUC__)
+        asm volatile("" : : : "memory");
+    #else
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+    #endif
+    }
+
+    /// Benchmark settings, total time is split evenly between samples.
+    struct BenchmarkOptions
+    {
+        std::chrono::nanoseconds MinTime{std::chrono::milliseconds{500}};
+        std::size_t Samples{50uz};
+    };
+
+    /// Benchmark result, all times are in nanoseconds per iteration.
+    struct BenchmarkStats
+    {
+        std::size_t Iterations{0uz}; // Per sample
+        std::size_t Samples{0uz};
+        double Min{0.0};
+        double Median{0.0};
+        double Mean{0.0};
+        double StdDev{0.0};
+        double P99{0.0};
+    };
+
+    /// Result of MTEST_CONCURRENT run.
+    struct ConcurrentStats
+    {
+        std::size_t Threads{0uz};
+        std::uint64_t Operations{0u}; // Body calls of all threads
+        std::vector<std::uint64_t> ThreadOperations{};
+        double Duration{0.0}; // In seconds
+        double OperationsPerSecond{0.0};
+    };
+
+    /// Benchmark state passed to benchmark body, body must iterate over it: for(auto _: benchmark) { ... }
+    class CBenchmark final
+    {
+        using BenchmarkClock = std::chrono::steady_clock;
+    public:
+        /// Iteration value, it is never used so compilers should not warn about it.
+        struct [[maybe_unused]] Value {};
+
+        class Iterator final
+        {
+        public:
+            Iterator(CBenchmark* owner, const std::size_t remaining):
+                Owner(owner),
+                Remaining(remaining)
+            {
+            }
+
+            Value operator*() const { return {}; }
+            Iterator& operator++()
+            {
+                --Remaining;
+                return *this;
+            }
+            bool operator!=(const Iterator&)
+            {
+                if( Remaining != 0uz ) [[likely]]
+                {
+                    return true;
+                }
+                Owner->Stop();
+                return false;
+            }
+        private:
+            CBenchmark* Owner{};
+            std::size_t Remaining{0uz};
+        };
+
+        explicit CBenchmark(const std::size_t iterations):
+            Iterations(iterations)
+        {
+        }
+        CBenchmark(const CBenchmark&) = delete;
+        CBenchmark(CBenchmark&&) = delete;
+        ~CBenchmark() = default;
+
+        CBenchmark& operator=(const CBenchmark&) = delete;
+        CBenchmark& operator=(CBenchmark&&) = delete;
+
+        std::size_t GetIterations() const { return Iterations; }
+        /// Returns nothing if body did not iterate over benchmark.
+        std::optional<std::chrono::nanoseconds> GetElapsed() const { return Elapsed; }
+
+        Iterator begin()
+        {
+            Start = BenchmarkClock::now();
+            return {this, Iterations};
+        }
+        Iterator end() { return {this, 0uz}; }
+    private:
+        void Stop()
+        {
+            Elapsed = BenchmarkClock::now() - Start;
+        }
+    private:
+        std::size_t Iterations{0uz};
+        BenchmarkClock::time_point Start{};
+        std::optional<std::chrono::nanoseconds> Elapsed{};
+    };
+
+    /// One line of CSV file. Fields are views into mapped file, quoted fields are returned without quotes
+    /// and doubled quotes inside them are not unescaped.
+    class CCsvRecord final
+    {
+    public:
+        CCsvRecord(const std::string_view line, const char separator):
+            Line(line),
+            Separator(separator)
+        {
+        }
+
+        std::string_view GetLine() const { return Line; }
+
+        std::size_t GetFieldCount() const
+        {
+            std::size_t count{0uz};
+            ForEachField([&](const std::string_view)
+            {
+                ++count;
+                return false;
+            });
+            return count;
+        }
+
+        /// Throws if field does not exist.
+        std::string_view operator[](const std::size_t index) const
+        {
+            std::size_t current{0uz};
+            std::optional<std::string_view> result{};
+            ForEachField([&](const std::string_view field)
+            {
+                if( current++ == index )
+                {
+                    result = field;
+                    return true;
+                }
+                return false;
+            });
+            if( !result )
+            {
+                throw std::out_of_range(std::format("Field {} does not exist in '{}'", index, Line));
+            }
+            return *result;
+        }
+
+        /// Field converted to given type, throws if it can not be parsed.
+        template<class T>
+        T Get(const std::size_t index) const
+        {
+            return Details::ParseField<T>((*this)[index]);
+        }
+    private:
+        /// Call function for each field until it returns true.
+        template<IsInvocable<bool, std::string_view> Function>
+        void ForEachField(Function function) const
+        {
+            std::size_t begin{0uz};
+            while( true )
+            {
+                std::size_t end{begin};
+                bool quoted{false};
+                while( end < Line.size() && (quoted || Line[end] != Separator) )
+                {
+                    if( Line[end] == '"' )
+                    {
+                        quoted = !quoted;
+                    }
+                    ++end;
+                }
+                std::string_view field = Line.substr(begin, end - begin);
+                if( field.size() >= 2uz && field.front() == '"' && field.back() == '"' )
+                {
+                    field = field.substr(1uz, field.size() - 2uz);
+                }
+                if( function(field) || end >= Line.size() )
+                {
+                    return;
+                }
+                begin = end + 1uz;
+            }
+        }
+    private:
+        std::string_view Line{};
+        char Separator{','};
+    };
+
+    /// One line of JSON Lines file. Only top level fields of object can be read, values are views into mapped file.
+    /// String values are returned without quotes and their escape sequences are not decoded, objects and arrays are returned as raw text.
+    class CJsonRecord final
+    {
+    public:
+        explicit CJsonRecord(const std::string_view line):
+            Line(line)
+        {
+        }
+
+        std::string_view GetLine() const { return Line; }
+
+        /// Value of top level field, nothing if object does not have it.
+        std::optional<std::string_view> Find(const std::string_view key) const
+        {
+            std::size_t i = SkipSpace(0uz);
+            if( i >= Line.size() || Line[i] != '{' )
+            {
+                return std::nullopt;
+            }
+            ++i;
+            while( true )
+            {
+                i = SkipSpace(i);
+                if( i >= Line.size() || Line[i] != '"' )
+                {
+                    return std::nullopt;
+                }
+                const std::size_t keyEnd = SkipValue(i);
+                const std::string_view name = Line.substr(i + 1uz, keyEnd - i - 2uz);
+                i = SkipSpace(keyEnd);
+                if( i >= Line.size() || Line[i] != ':' )
+                {
+                    return std::nullopt;
+                }
+                i = SkipSpace(i + 1uz);
+                const std::size_t valueEnd = SkipValue(i);
+                if( name == key )
+                {
+                    std::string_view value = Line.substr(i, valueEnd - i);
+                    if( value.size() >= 2uz && value.front() == '"' )
+                    {
+                        value = value.substr(1uz, value.size() - 2uz);
+                    }
+                    return value;
+                }
+                i = SkipSpace(valueEnd);
+                if( i >= Line.size() || Line[i] != ',' )
+                {
+                    return std::nullopt;
+                }
+                ++i;
+            }
+        }
+
+        /// Throws if field does not exist.
+        std::string_view operator[](const std::string_view key) const
+        {
+            const auto value = Find(key);
+            if( !value )
+            {
+                throw std::out_of_range(std::format("Field '{}' does not exist in '{}'", key, Line));
+            }
+            return *value;
+        }
+
+        /// Field converted to given type, throws if it does not exist or can not be parsed.
+        template<class T>
+        T Get(const std::string_view key) const
+        {
+            return Details::ParseField<T>((*this)[key]);
+        }
+    private:
+        std::size_t SkipSpace(std::size_t i) const
+        {
+            while( i < Line.size() && (Line[i] == ' ' || Line[i] == '\t' || Line[i] == '\r' || Line[i] == '\n') )
+            {
+                ++i;
+            }
+            return i;
+        }
+
+        /// Returns position right after value starting at given position.
+        std::size_t SkipValue(std::size_t i) const
+        {
+            std::size_t depth{0uz};
+            bool quoted{false};
+            for(; i < Line.size(); ++i)
+            {
+                const char c = Line[i];
+                if( quoted )
+                {
+                    if( c == '\\' )
+                    {
+                        ++i;
+                    }
+                    else if( c == '"' )
+                    {
+                        quoted = false;
+                        if( depth == 0uz )
+                        {
+                            return i + 1uz;
+                        }
+                    }
+                }
+                else if( c == '"' )
+                {
+                    quoted = true;
+                }
+                else if( c == '{' || c == '[' )
+                {
+                    ++depth;
+                }
+                else if( c == '}' || c == ']' )
+                {
+                    if( depth == 0uz )
+                    {
+                        return i;
+                    }
+                    if( --depth == 0uz )
+                    {
+                        return i + 1uz;
+                    }
+                }
+                else if( depth == 0uz && (c == ',' || c == ' ' || c == '\t' || c == '\r' || c == '\n') )
+                {
+                    return i;
+                }
+            }
+            return std::min(i, Line.size());
+        }
+    private:
+        std::string_view Line{};
+    };
+
+    /// Table test generator reading rows from CSV file. File is memory mapped on first access and each row is decoded
+    /// only when its test case runs. Quoted field can contain line break. If file can not be opened or has unclosed quote it has single row which fails.
+    template<class T>
+    class CCsvDataset final
+    {
+    public:
+        using DataType = T;
+        using Decoder = std::function<T(const CCsvRecord&)>;
+
+        CCsvDataset(std::string path, Decoder decoder, const bool hasHeader = true, const char separator = ','):
+            File(std::move(path), Details::EDatasetRecords::Csv, hasHeader ? 1uz : 0uz),
+            Decode(std::move(decoder)),
+            Separator(separator)
+        {
+        }
+
+        std::size_t size() const { return File.IsValid() ? File.GetLineCount() : 1uz; }
+        T operator[](const std::size_t i) const { return Decode(CCsvRecord{File.GetLine(i), Separator}); }
+    private:
+        Details::CDatasetFile File;
+        Decoder Decode{};
+        char Separator{','};
+    };
+
+    /// Table test generator reading rows from JSON Lines file. File is memory mapped on first access and each row is decoded
+    /// only when its test case runs. If file can not be opened it has single row which fails.
+    template<class T>
+    class CJsonLinesDataset final
+    {
+    public:
+        using DataType = T;
+        using Decoder = std::function<T(const CJsonRecord&)>;
+
+        CJsonLinesDataset(std::string path, Decoder decoder):
+            File(std::move(path), Details::EDatasetRecords::Lines, 0uz),
+            Decode(std::move(decoder))
+        {
+        }
+
+        std::size_t size() const { return File.IsValid() ? File.GetLineCount() : 1uz; }
+        T operator[](const std::size_t i) const { return Decode(CJsonRecord{File.GetLine(i)}); }
+    private:
+        Details::CDatasetFile File;
+        Decoder Decode{};
+    };
+
+    /// Table test generator reading rows from binary file of fixed size records, optionally preceded by header.
+    /// File is memory mapped on first access and record is copied only when its test case runs. If file can not be opened it has single row which fails.
+    template<class T>
+    class CBinaryDataset final
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Record type must be trivially copyable");
+    public:
+        using DataType = T;
+
+        explicit CBinaryDataset(std::string path, const std::size_t headerSize = 0uz):
+            File(std::move(path), Details::EDatasetRecords::None, 0uz),
+            HeaderSize(headerSize)
+        {
+        }
+
+        std::size_t size() const
+        {
+            if( !File.IsValid() )
+            {
+                return 1uz;
+            }
+            const std::size_t size = File.GetData().size();
+            return size > HeaderSize ? (size - HeaderSize) / sizeof(T) : 0uz;
+        }
+
+        T operator[](const std::size_t i) const
+        {
+            const std::string_view data = File.GetData();
+            const std::size_t offset = HeaderSize + i * sizeof(T);
+            if( offset + sizeof(T) > data.size() )
+            {
+                throw std::out_of_range(std::format("Record {} is out of range of dataset", i));
+            }
+            T record{};
+            std::memcpy(&record, data.data() + offset, sizeof(T));
+            return record;
+        }
+    private:
+        Details::CDatasetFile File;
+        std::size_t HeaderSize{0uz};
+    };
+
+    /// Fixture shared by test cases of section or by all test cases, see MTEST_SECTION_FIXTURE and MTEST_GLOBAL_FIXTURE.
+    /// Each worker thread or process has its own instance.
+    struct SharedFixture
+    {
+        SharedFixture() = default;
+        SharedFixture(const SharedFixture&) = delete;
+        SharedFixture(SharedFixture&&) = delete;
+        virtual ~SharedFixture() = default;
+
+        SharedFixture& operator=(const SharedFixture&) = delete;
+        SharedFixture& operator=(SharedFixture&&) = delete;
+
+        /// Called before first test case which needs fixture, assertions fail that test case.
+        virtual void Setup() {}
+        /// Called after last test case of section in serial run, otherwise when worker ends. It is not run as part of test case,
+        /// so assertions must not be used - throw exception to report error.
+        virtual void Cleanup() {}
+    };
+
+    /// Static record of shared fixture.
+    struct SharedFixtureDescriptor
+    {
+        using CreateFunction = std::unique_ptr<SharedFixture>(*)();
+
+        const char* Section{}; // Null for global fixture
+        const char* Name{};
+        CreateFunction Create{};
+        const SharedFixtureDescriptor* Next{};
+    };
+
+    namespace Details
+    {
+        /// Intrusive list of registered shared fixtures, newest first.
+        constinit inline const SharedFixtureDescriptor* RegisteredSharedFixtures{nullptr};
+
+        struct SharedFixtureInstance
+        {
+            const SharedFixtureDescriptor* Descriptor{};
+            std::unique_ptr<SharedFixture> Fixture{};
+        };
+
+        /// Shared fixtures of current worker in order of setup, fixture is null if its setup failed.
+        inline std::vector<SharedFixtureInstance>& GetSharedFixtures()
+        {
+            thread_local std::vector<SharedFixtureInstance> fixtures{};
+            return fixtures;
+        }
+
+        inline bool IsSharedFixtureOf(const SharedFixtureDescriptor& descriptor, const std::string& section)
+        {
+            return !descriptor.Section || descriptor.Section == section;
+        }
+
+        /// Set up global fixtures and fixtures of given section which are not yet set up on this worker, in registration order.
+        /// Throws if setup of any of them failed.
+        inline void AcquireSharedFixtures(const std::string& section)
+        {
+            if( !RegisteredSharedFixtures )
+            {
+                return;
+            }
+            std::vector<const SharedFixtureDescriptor*> descriptors{};
+            for(const auto* i = RegisteredSharedFixtures; i; i = i->Next)
+            {
+                if( IsSharedFixtureOf(*i, section) )
+                {
+                    descriptors.push_back(i);
+                }
+            }
+            // Global fixtures first
+            std::ranges::stable_partition(descriptors.rbegin(), descriptors.rend(), [](const auto* i) { return !i->Section; });
+            auto& fixtures = GetSharedFixtures();
+            for(auto i = descriptors.rbegin(); i != descriptors.rend(); ++i)
+            {
+                const auto* descriptor = *i;
+                const auto it = std::ranges::find(fixtures, descriptor, &SharedFixtureInstance::Descriptor);
+                if( it != fixtures.end() )
+                {
+                    if( !it->Fixture )
+                    {
+                        throw std::runtime_error(std::format("Setup of shared fixture '{}' failed", descriptor->Name));
+                    }
+                    continue;
+                }
+                // Shared state lives longer than test case, so it is not its allocation
+                const CAllocationPause pause{};
+                auto& instance = fixtures.emplace_back(descriptor, nullptr);
+                auto fixture = descriptor->Create();
+                fixture->Setup();
+                instance.Fixture = std::move(fixture);
+            }
+        }
+
+        /// Clean up shared fixtures of this worker in reverse order of setup, only fixtures of given section if it is given.
+        inline void ReleaseSharedFixtures(const std::string* section)
+        {
+            const CAllocationPause pause{};
+            auto& fixtures = GetSharedFixtures();
+            for(auto i = fixtures.size(); i > 0uz; --i)
+            {
+                auto& instance = fixtures[i-1uz];
+                if( section && (!instance.Descriptor->Section || instance.Descriptor->Section != *section) )
+                {
+                    continue;
+                }
+                if( instance.Fixture )
+                {
+                    try
+                    {
+                        instance.Fixture->Cleanup();
+                    }
+                    catch(const std::exception& e)
+                    {
+                        GetLog().Write(EConsoleColor::Red, "[Error  ] Cleanup of shared fixture '{}' failed: {}\n", instance.Descriptor->Name, e.what());
+                    }
+                    catch(...)
+                    {
+                        GetLog().Write(EConsoleColor::Red, "[Error  ] Cleanup of shared fixture '{}' failed: Unknown exception was thrown\n", instance.Descriptor->Name);
+                    }
+                }
+                fixtures.erase(fixtures.begin() + static_cast<std::ptrdiff_t>(i-1uz));
+            }
+        }
+    }
+
+    /// Event of trace timeline, times are in nanoseconds of steady clock, so they are comparable between worker processes.
+    struct TraceEvent
+    {
+        std::string Name{};
+        std::string Category{};
+        char Phase{'X'}; // 'X' is span, 'i' is instant event
+        std::uint64_t Start{0u};
+        std::uint64_t Duration{0u};
+        std::uint32_t Process{0u};
+        std::uint32_t Thread{0u};
+    };
+    using TraceBuffer = std::vector<TraceEvent>;
+
+    namespace Details
+    {
+        /// Set when --trace-out is given.
+        constinit inline bool CollectTrace{false};
+        /// Trace of test case run on this thread, null when trace is not collected.
+        constinit inline thread_local TraceBuffer* ActiveTrace{nullptr};
+
+        inline std::uint64_t TraceNow()
+        {
+            return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+
+        /// Track of calling thread: process id and small thread index, main thread has index zero.
+        inline std::pair<std::uint32_t, std::uint32_t> TraceTrack()
+        {
+            static std::atomic<std::uint32_t> nextThread{0u};
+            thread_local const std::uint32_t thread = nextThread.fetch_add(1u, std::memory_order_relaxed);
+        #ifdef MTEST_LINUX_PLATFORM
+            return {static_cast<std::uint32_t>(::getpid()), thread};
+        #else
+            return {0u, thread};
+        #endif
+        }
+
+        inline void AddTraceEvent(const std::string_view name, const std::string_view category, const char phase, const std::uint64_t start,
+            const std::uint64_t duration)
+        {
+            const CAllocationPause pause{};
+            const auto [process, thread] = TraceTrack();
+            ActiveTrace->push_back({std::string{name}, std::string{category}, phase, start, duration, process, thread});
+        }
+
+        /// Add instant event to trace of active test case.
+        inline void TraceInstant(const std::string_view name, const std::string_view category)
+        {
+            if( ActiveTrace )
+            {
+                AddTraceEvent(name, category, 'i', TraceNow(), 0u);
+            }
+        }
+
+        /// Adds span of its lifetime to trace of active test case.
+        class CTraceScope final
+        {
+        public:
+            CTraceScope(const std::string_view name, const std::string_view category)
+            {
+                if( ActiveTrace ) [[unlikely]]
+                {
+                    const CAllocationPause pause{};
+                    Name = name;
+                    Category = category;
+                    Start = TraceNow();
+                }
+            }
+            CTraceScope(const CTraceScope&) = delete;
+            CTraceScope(CTraceScope&&) = delete;
+            ~CTraceScope()
+            {
+                if( ActiveTrace && Start > 0u ) [[unlikely]]
+                {
+                    AddTraceEvent(Name, Category, 'X', Start, TraceNow() - Start);
+                }
+            }
+
+            CTraceScope& operator=(const CTraceScope&) = delete;
+            CTraceScope& operator=(CTraceScope&&) = delete;
+        private:
+            std::string Name{};
+            std::string Category{};
+            std::uint64_t Start{0u};
+        };
+
+        template<class T>
+        void WriteInfo(const T& message)
+        {
+            GetLog().Write("[Message] {}\n", message);
+            if( ActiveTrace )
+            {
+                TraceInstant(std::format("{}", message), "message");
+            }
+        }
+    }
+
+    namespace Details
+    {
+        /// Set before tests are run from --timeout, zero means test cases have no time limit.
+        constinit inline std::chrono::milliseconds DefaultTimeout{0};
+
+        /// Sends reason of abort of current task to main process and exits. Must not return.
+        using AbortWorkerFunction = void(*)(const std::string&);
+        /// Set in isolated worker process.
+        constinit inline AbortWorkerFunction AbortWorker{nullptr};
+
+        /// State of running test case seen by watchdog. Assertions of watched test case only store their location with relaxed stores,
+        /// it is read when time limit expires. Armed is written only by thread of test case.
+        struct WatchState
+        {
+            const std::string* Name{};
+            std::chrono::milliseconds Timeout{0};
+            bool Armed{false};
+            std::atomic<const char*> File{nullptr};
+            std::atomic<std::uint_least32_t> Line{0u};
+            std::atomic<bool> Expired{false};
+        };
+
+        inline std::string FormatTimeout(const WatchState& state, const std::chrono::milliseconds timeout)
+        {
+            const char* file = state.File.load(std::memory_order_relaxed);
+            if( !file )
+            {
+                return std::format("Test case timed out after {} ms, no assertion was reached", timeout.count());
+            }
+            return std::format("Test case timed out after {} ms, last assertion reached in File: {}, Line: {}", timeout.count(),
+                FilenameFromPath(file), state.Line.load(std::memory_order_relaxed));
+        }
+
+        /// Single thread which sleeps until nearest deadline of watched test cases. Test case which runs over its limit is reported
+        /// and marked as timed out. In isolated worker its process is ended, otherwise whole run is aborted if it is still running
+        /// after another period of its limit, because thread can not be stopped safely.
+        /// Thread is started on first use, so only process which runs tests has it.
+        class CWatchdog final
+        {
+            using WatchdogClock = std::chrono::steady_clock;
+
+            struct Entry
+            {
+                WatchState* State{};
+                std::chrono::milliseconds Timeout{0};
+                WatchdogClock::time_point Deadline{};
+                bool Expired{false};
+            };
+        public:
+            CWatchdog() = default;
+            CWatchdog(const CWatchdog&) = delete;
+            CWatchdog(CWatchdog&&) = delete;
+            ~CWatchdog()
+            {
+                {
+                    const std::lock_guard lock{Mutex};
+                    Stopping = true;
+                }
+                Wake.notify_one();
+                if( Thread.joinable() )
+                {
+                    Thread.join();
+                }
+            }
+
+            CWatchdog& operator=(const CWatchdog&) = delete;
+            CWatchdog& operator=(CWatchdog&&) = delete;
+
+            /// Start watching test case from now, replaces previous limit of the same test case.
+            void Arm(WatchState& state, const std::chrono::milliseconds timeout)
+            {
+                {
+                    const std::lock_guard lock{Mutex};
+                    if( !Thread.joinable() )
+                    {
+                        Thread = std::thread([this]() { Loop(); });
+                    }
+                    std::erase_if(Entries, [&](const Entry& i) { return i.State == &state; });
+                    Entries.push_back({&state, timeout, WatchdogClock::now() + timeout});
+                    state.Timeout = timeout;
+                    state.Armed = true;
+                }
+                Wake.notify_one();
+            }
+
+            /// Stop watching test case, after return watchdog does not touch it.
+            void Disarm(WatchState& state)
+            {
+                const std::lock_guard lock{Mutex};
+                std::erase_if(Entries, [&](const Entry& i) { return i.State == &state; });
+                state.Armed = false;
+            }
+        private:
+            void Loop()
+            {
+                std::unique_lock lock{Mutex};
+                while( !Stopping )
+                {
+                    const auto now = WatchdogClock::now();
+                    auto next = WatchdogClock::time_point::max();
+                    for(auto& i: Entries)
+                    {
+                        if( now >= i.Deadline )
+                        {
+                            if( i.Expired )
+                            {
+                                AbortRun(i);
+                            }
+                            Expire(i);
+                        }
+                        next = std::min(next, i.Deadline);
+                    }
+                    if( next == WatchdogClock::time_point::max() )
+                    {
+                        Wake.wait(lock);
+                    }
+                    else
+                    {
+                        Wake.wait_until(lock, next);
+                    }
+                }
+            }
+
+            void Expire(Entry& entry)
+            {
+                const std::string reason = FormatTimeout(*entry.State, entry.Timeout);
+                if( AbortWorker )
+                {
+                    // Only this worker process is ended, main process reports test case and starts new worker.
+                    AbortWorker(reason);
+                }
+                entry.Expired = true;
+                entry.Deadline += entry.Timeout;
+                entry.State->Expired.store(true, std::memory_order_relaxed);
+                GetLog().Write(EConsoleColor::Red, "[Timeout] {}: {}\n", *entry.State->Name, reason);
+            }
+
+            [[noreturn]] void AbortRun(const Entry& entry)
+            {
+                const std::string reason = std::format("{} is still running after {} ms", *entry.State->Name, (entry.Timeout * 2).count());
+                GetLog().Write(EConsoleColor::Red, "[Fatal  ] {}, run is aborted. Use --isolate to continue after hung test case\n", reason);
+                GetLog().Flush();
+                // Destructors are not run, so reports are closed here.
+                GetLog().Notify([&](ISink& sink) { sink.OnRunAbort(reason); });
+                std::_Exit(EXIT_FAILURE);
+            }
+        private:
+            std::mutex Mutex{};
+            std::condition_variable Wake{};
+            std::vector<Entry> Entries{};
+            std::thread Thread{};
+            bool Stopping{false};
+        };
+
+        inline CWatchdog& GetWatchdog()
+        {
+            static CWatchdog watchdog{};
+            return watchdog;
+        }
+    }
+
+    /// Represents one test case
+    class CTestCase final
+    {
+        using TestClock = std::chrono::steady_clock;
+        using TestClockStamp = std::chrono::steady_clock::time_point;
+        using TestClockDuration = std::chrono::duration<float, std::milli>;
+    public:
+        CTestCase(const std::string& section, const std::string& name, const std::source_location location, FixtureFactory factory):
+            Section(section),
+            Name(name),
+            Fullname(MakeFullname(section, name)),
+            File(Details::FilenameFromPath(location.file_name())),
+            Path(location.file_name()),
+            Line(location.line()),
+            Factory(std::move(factory))
+        {
+            Watch.Name = &Fullname;
+        }
+        CTestCase(const CTestCase&) = delete;
+        CTestCase(CTestCase&&) = delete;
+        ~CTestCase() = default;
+        
+        CTestCase& operator=(const CTestCase&) = delete;
+        CTestCase& operator=(CTestCase&&) = delete;
+
+        const std::string& GetSection() const { return Section; }
+        const std::string& GetName() const { return Name; }
+        const std::string& GetFullname() const { return Fullname; }
+        const std::string& GetFile() const { return File; }
+        /// Path of source file as given to compiler.
+        const std::string& GetPath() const { return Path; }
+        std::uint_least32_t GetLine() const { return Line; }
+        bool IsFailed() const { return Result == ETestResult::Fail; }
+        bool IsSkipped() const { return Result == ETestResult::Skip; }
+        /// Async test case is coroutine, see MTEST_ASYNC_UNIT_TEST.
+        bool IsAsync() const { return Async; }
+        void MarkAsync() { Async = true; }
+        /// Test case runs one row of generated table test, name of row is generated when row is made.
+        void MarkGeneratedRow() { GeneratedRow = true; }
+        /// True when watchdog has seen test case running over its limit.
+        bool IsTimedOut() const { return Watch.Expired.load(std::memory_order_relaxed); }
+        /// True while test case runs with time limit.
+        bool IsWatched() const { return Watch.Armed; }
+        ETestResult GetResult() const { return Result; }
+        float GetDuration() const { return Duration; }
+        const std::vector<TestFailure>& GetFailures() const { return Failures; }
+        const std::string& GetSkipReason() const { return SkipReason; }
+        /// Benchmark result, present only for benchmarks.
+        const std::optional<BenchmarkStats>& GetBenchmarkStats() const { return Benchmark; }
+        void SetBenchmarkStats(const BenchmarkStats& stats) { Benchmark = stats; }
+        /// Allocations made by test case, present only when MTEST_CONFIG_TRACK_ALLOCATIONS is defined.
+        const std::optional<AllocationStats>& GetAllocationStats() const { return Allocations; }
+        /// Performance counters of test body, present only when run with --perf-counters.
+        const std::optional<PerfCounterStats>& GetPerfCounters() const { return PerfCounters; }
+        /// Output buffered while test case was run on worker thread.
+        LogBuffer& GetOutput() { return Output; }
+        /// Trace events of test case, collected only when run with --trace-out.
+        TraceBuffer& GetTrace() { return Trace; }
+        const TraceBuffer& GetTrace() const { return Trace; }
+        /// Signal that test case run on worker thread is done.
+        void MarkFinished()
+        {
+            Finished.store(true, std::memory_order_release);
+            Finished.notify_all();
+        }
+        /// Block until test case run on worker thread is done.
+        void WaitFinished() const { Finished.wait(false, std::memory_order_acquire); }
+        bool IsFinished() const { return Finished.load(std::memory_order_acquire); }
+
+        /// Clear result of previous run, so test case can be run again.
+        void Reset()
+        {
+            Result = ETestResult::Success;
+            Duration = 0.0f;
+            Failures.clear();
+            SkipReason.clear();
+            Benchmark.reset();
+            Allocations.reset();
+            PerfCounters.reset();
+            Output.clear();
+            Trace.clear();
+            Finished.store(false, std::memory_order_release);
+        }
+
+        /// Serialize result and buffered output, used to pass them from worker process.
+        std::string SaveResult() const
+        {
+            Details::CBinaryWriter writer{};
+            writer.Write(Result);
+            writer.Write(Duration);
+            writer.Write(Benchmark.has_value());
+            writer.Write(Benchmark.value_or(BenchmarkStats{}));
+            writer.Write(Allocations.has_value());
+            writer.Write(Allocations.value_or(AllocationStats{}));
+            writer.Write(PerfCounters.has_value());
+            writer.Write(PerfCounters.value_or(PerfCounterStats{}));
+            writer.Write<std::uint64_t>(Failures.size());
+            for(const auto& i: Failures)
+            {
+                writer.Write(i.Type);
+                writer.Write(i.Message);
+                writer.Write(i.File);
+                writer.Write(i.Line);
+            }
+            writer.Write(SkipReason);
+            writer.Write<std::uint64_t>(Output.size());
+            for(const auto& i: Output)
+            {
+                writer.Write(i.Color);
+                writer.Write(i.HasColor);
+                writer.Write(i.Text);
+            }
+            writer.Write<std::uint64_t>(Trace.size());
+            for(const auto& i: Trace)
+            {
+                writer.Write(i.Name);
+                writer.Write(i.Category);
+                writer.Write(i.Phase);
+                writer.Write(i.Start);
+                writer.Write(i.Duration);
+                writer.Write(i.Process);
+                writer.Write(i.Thread);
+            }
+            return writer.GetData();
+        }
+
+        /// Load result saved by SaveResult.
+        void LoadResult(const std::string_view data)
+        {
+            Details::CBinaryReader reader{data};
+            Result = reader.Read<ETestResult>();
+            Duration = reader.Read<float>();
+            const bool hasBenchmark = reader.Read<bool>();
+            const auto benchmark = reader.Read<BenchmarkStats>();
+            Benchmark = hasBenchmark ? std::optional{benchmark} : std::nullopt;
+            const bool hasAllocations = reader.Read<bool>();
+            const auto allocations = reader.Read<AllocationStats>();
+            Allocations = hasAllocations ? std::optional{allocations} : std::nullopt;
+            const bool hasPerfCounters = reader.Read<bool>();
+            const auto perfCounters = reader.Read<PerfCounterStats>();
+            PerfCounters = hasPerfCounters ? std::optional{perfCounters} : std::nullopt;
+            const auto failures = reader.Read<std::uint64_t>();
+            Failures.clear();
+            for(std::uint64_t i{0u}; i < failures; ++i)
+            {
+                TestFailure failure{};
+                failure.Type = reader.Read<EFailType>();
+                failure.Message = reader.ReadString();
+                failure.File = reader.ReadString();
+                failure.Line = reader.Read<std::uint_least32_t>();
+                Failures.push_back(std::move(failure));
+            }
+            SkipReason = reader.ReadString();
+            const auto records = reader.Read<std::uint64_t>();
+            Output.clear();
+            for(std::uint64_t i{0u}; i < records; ++i)
+            {
+                LogRecord record{};
+                record.Color = reader.Read<EConsoleColor>();
+                record.HasColor = reader.Read<bool>();
+                record.Text = reader.ReadString();
+                Output.push_back(std::move(record));
+            }
+            const auto events = reader.Read<std::uint64_t>();
+            Trace.clear();
+            for(std::uint64_t i{0u}; i < events; ++i)
+            {
+                TraceEvent event{};
+                event.Name = reader.ReadString();
+                event.Category = reader.ReadString();
+                event.Phase = reader.Read<char>();
+                event.Start = reader.Read<std::uint64_t>();
+                event.Duration = reader.Read<std::uint64_t>();
+                event.Process = reader.Read<std::uint32_t>();
+                event.Thread = reader.Read<std::uint32_t>();
+                Trace.push_back(std::move(event));
+            }
+        }
+
+        /// Report test case which could not finish, eg. its process crashed.
+        void Abort(const std::string& reason, const float duration)
+        {
+            GetLog().Write(EConsoleColor::Blue, "[Start  ] {}\n", GetFullname());
+            HandleException(reason);
+            Duration = duration;
+            PrintResult(true);
+        }
+
+        static std::string MakeFullname(const std::string& section, const std::string& name) { return std::format("{}.{}", section, name); }
+
+        bool IsRun(const std::string& filter) const
+        {
+            if( !filter.empty() )
+            {
+                return GetFullname().contains(filter);
+            }
+            return true;
+        }
+
+        void Run(const std::string& filter)
+        {
+            const TestClockStamp Start = TestClock::now();
+            const Details::CTraceScope trace{GetFullname(), "test"};
+            GetLog().Write(EConsoleColor::Blue, "[Start  ] {}\n", GetFullname());
+            const Details::AllocationCounters allocations = BeginAllocations();
+            if( !IsRun(filter) )
+            {
+                // Skipped before shared fixtures are acquired, so they are not set up for filtered out test cases
+                Runner([&]()
+                {
+                    Skip("Test case is skipped by Command-line");
+                });
+            }
+            else
+            {
+                std::string rowName{};
+                RunFixture([&]()
+                {
+                    auto fixture = Factory();
+                    if( GeneratedRow )
+                    {
+                        // Name is generated once from row before Setup, fixture is not used after Cleanup
+                        rowName = fixture->MTest_GenerateName();
+                    }
+                    return fixture;
+                });
+                if( IsFailed() && !rowName.empty() )
+                {
+                    ReportRow(rowName);
+                }
+            }
+            EndAllocations(allocations);
+            Duration = TestClockDuration(TestClock::now()-Start).count();
+            PrintResult(true);
+        }
+
+        /// Run async test case as coroutine on event loop together with other async test cases, test case is finished when it completes.
+        /// Allocations and performance counters are not measured, as they are counted per thread.
+        Task RunConcurrent(const std::string filter)
+        {
+            AsyncStart = TestClock::now();
+            {
+                const Details::CTraceScope trace{GetFullname(), "test"};
+                GetLog().Write(EConsoleColor::Blue, "[Start  ] {}\n", GetFullname());
+                FixtureWrapperPtr fixture{};
+                bool needCleanup{false};
+                bool ready{false};
+                StartWatch(Details::DefaultTimeout);
+                Runner([&]()
+                {
+                    if( !IsRun(filter) )
+                    {
+                        Skip("Test case is skipped by Command-line");
+                    }
+                    const Details::CTraceScope setupTrace{"Setup", "setup"};
+                    Details::AcquireSharedFixtures(Section);
+                    fixture = Factory();
+                    if( const auto timeout = fixture->MTest_Timeout(); timeout > std::chrono::milliseconds{0} )
+                    {
+                        StartWatch(timeout);
+                    }
+                    if( fixture->MTest_Skip() )
+                    {
+                        Skip("Test case is skipped by Fixture");
+                    }
+                    needCleanup = true;
+                    fixture->MTest_Setup();
+                    ready = true;
+                });
+                if( ready )
+                {
+                    const Details::CTraceScope runTrace{"Run", "run"};
+                    std::exception_ptr error{};
+                    try
+                    {
+                        co_await fixture->MTest_RunAsync();
+                    }
+                    catch(...)
+                    {
+                        error = std::current_exception();
+                    }
+                    if( error )
+                    {
+                        Runner([&]()
+                        {
+                            std::rethrow_exception(error);
+                        });
+                    }
+                }
+                if( needCleanup )
+                {
+                    const Details::CTraceScope cleanupTrace{"Cleanup", "cleanup"};
+                    Runner([&]()
+                    {
+                        fixture->MTest_Cleanup();
+                    });
+                }
+                StopWatch();
+            }
+            Duration = TestClockDuration(TestClock::now()-AsyncStart).count();
+            PrintResult(true);
+            MarkFinished();
+        }
+
+        /// Finish async test case which is suspended but nothing can resume it, its coroutine is already destroyed.
+        void AbortSuspended()
+        {
+            HandleException("Async test case is suspended, but it does not wait for any MTest operation");
+            StopWatch();
+            Duration = TestClockDuration(TestClock::now()-AsyncStart).count();
+            PrintResult(true);
+            MarkFinished();
+        }
+
+        template<IsEnumeration T>
+        bool CheckEqual(const T& value, const T& wanted, const std::string_view message, const EFailType type,
+            const std::source_location location = std::source_location::current())
+        {
+            return CheckEqual(std::to_underlying(value), std::to_underlying(wanted), message, type, location);
+        }
+
+        template<class T, class U>
+        bool CheckEqual(const T& value, const U& wanted, const std::string_view message, const EFailType type,
+            const std::source_location location = std::source_location::current())
+        {
+            Reached(location);
+            if( value == wanted ) [[likely]]
+            {
+                return true;
+            }
+            HandleFailure(Details::FormatInequality(message, value, wanted), type, location);
+            return false;
+        }
+
+        template<IsEnumeration T>
+        bool CheckNotEqual(const T& value, const T& wanted, const std::string_view message, const EFailType type,
+            const std::source_location location = std::source_location::current())
+        {
+            return CheckNotEqual(std::to_underlying(value), std::to_underlying(wanted), message, type, location);
+        }
+
+        template<class T, class U>
+        bool CheckNotEqual(const T& value, const U& wanted, const std::string_view message, const EFailType type,
+            const std::source_location location = std::source_location::current())
+        {
+            Reached(location);
+            if( value != wanted ) [[likely]]
+            {
+                return true;
+            }
+            HandleFailure(std::format("Value '{}' should not be '{}'", message, wanted), type, location);
+            return false;
+        }
+
+        template<IsPointerType T, IsPointerType U>
+        bool CheckPointer(const T& value, const U& wanted, const std::string_view message, const EFailType type,
+            const std::source_location location = std::source_location::current())
+        {
+            Reached(location);
+            if( value == wanted ) [[likely]]
+            {
+                return true;
+            }
+            HandleFailure(std::format("Pointer '{}' should be {}", message, Details::FormatPointer(wanted)), type, location);
+            return false;
+        }
+
+        template<IsPointerType T, IsPointerType U>
+        bool CheckNotPointer(const T& value, const U& wanted, const std::string_view message, const EFailType type,
+            const std::source_location location = std::source_location::current())
+        {
+            Reached(location);
+            if( value != wanted ) [[likely]]
+            {
+                return true;
+            }
+            HandleFailure(std::format("Pointer '{}' should not be {}", message, Details::FormatPointer(wanted)), type, location);
+            return false;
+        }
+
+        bool CheckTrue(const bool result, const std::string_view message, const EFailType type, const std::source_location location = std::source_location::current())
+        {
+            Reached(location);
+            if( result ) [[likely]]
+            {
+                return true;
+            }
+            HandleFailure(std::format("Expression '{}' should evaluate to true", message), type, location);
+            return false;
+        }
+
+        bool CheckFalse(const bool result, const std::string_view message, const EFailType type, const std::source_location location = std::source_location::current())
+        {
+            Reached(location);
+            if( !result ) [[likely]]
+            {
+                return true;
+            }
+            HandleFailure(std::format("Expression '{}' should evaluate to false", message), type, location);
+            return false;
+        }
+
+        template<class T, class E>
+        bool CheckNear(const T& value, const T& wanted, const E& epsilon, const std::string_view message, const EFailType type,
+            const std::source_location location = std::source_location::current())
+        {
+            Reached(location);
+            if( IsNear(value, wanted, epsilon) ) [[likely]]
+            {
+                return true;
+            }
+            HandleFailure(std::format("Value '{}' is '{}' but should be '{}' with {}", message, value, wanted, Details::FormatTolerance(epsilon)), type, location);
+            return false;
+        }
+
+        template<std::ranges::random_access_range R, std::ranges::random_access_range W>
+            requires std::ranges::sized_range<const R> && std::ranges::sized_range<const W>
+        bool CheckRangeEqual(const R& value, const W& wanted, const std::string_view message, const EFailType type,
+            const std::source_location location = std::source_location::current())
+        {
+            Reached(location);
+            const auto size = static_cast<std::size_t>(std::ranges::size(value));
+            const auto wantedSize = static_cast<std::size_t>(std::ranges::size(wanted));
+            if( size != wantedSize )
+            {
+                HandleFailure(std::format("Range '{}' has {} elements but should have {}", message, size, wantedSize), type, location);
+                return false;
+            }
+            const auto mismatches = Details::FindMismatches(size, [&](const std::size_t start)
+            {
+                return Details::FindUnequal(value, wanted, size, start);
+            });
+            if( !mismatches ) [[likely]]
+            {
+                return true;
+            }
+            HandleFailure(Details::FormatMismatches(message, value, wanted, size, *mismatches), type, location);
+            return false;
+        }
+
+        template<std::ranges::random_access_range R, std::ranges::random_access_range W, class E>
+            requires std::ranges::sized_range<const R> && std::ranges::sized_range<const W>
+        bool CheckRangeNear(const R& value, const W& wanted, const E& tolerance, const std::string_view message, const EFailType type,
+            const std::source_location location = std::source_location::current())
+        {
+            Reached(location);
+            const auto size = static_cast<std::size_t>(std::ranges::size(value));
+            const auto wantedSize = static_cast<std::size_t>(std::ranges::size(wanted));
+            if( size != wantedSize )
+            {
+                HandleFailure(std::format("Range '{}' has {} elements but should have {}", message, size, wantedSize), type, location);
+                return false;
+            }
+            const auto mismatches = Details::FindMismatches(size, [&](const std::size_t start)
+            {
+                return Details::FindNotNear(value, wanted, tolerance, size, start);
+            });
+            if( !mismatches ) [[likely]]
+            {
+                return true;
+            }
+            HandleFailure(std::format("{} with {}", Details::FormatMismatches(message, value, wanted, size, *mismatches),
+                Details::FormatTolerance(tolerance)), type, location);
+            return false;
+        }
+
+        bool CheckBytesEqual(const void* value, const void* wanted, const std::size_t size, const std::string_view message, const EFailType type,
+            const std::source_location location = std::source_location::current())
+        {
+            Reached(location);
+            const std::span<const std::byte> valueBytes{static_cast<const std::byte*>(value), size};
+            const std::span<const std::byte> wantedBytes{static_cast<const std::byte*>(wanted), size};
+            const auto mismatches = Details::FindMismatches(size, [&](const std::size_t start)
+            {
+                return Details::FindByteMismatch(valueBytes.data(), wantedBytes.data(), size, start);
+            });
+            if( !mismatches ) [[likely]]
+            {
+                return true;
+            }
+            HandleFailure(Details::FormatMismatches(message, valueBytes, wantedBytes, size, *mismatches), type, location);
+            return false;
+        }
+
+        template<class E, IsInvocable<void> Invocable>
+        bool CheckThrow(Invocable invocable, const std::string_view message, const std::string_view exception, const EFailType type,
+            const std::source_location location = std::source_location::current())
+        {
+            Reached(location);
+            try
+            {
+                invocable();
+                HandleFailure(std::format("Expression '{}' should throw '{}' but none exception was thrown", message, exception), type, location);
+                return false;
+            }
+            catch(E&)
+            {
+                return true;
+            }
+            catch(...)
+            {
+                HandleFailure(std::format("Expression '{}' should throw '{}' but another exception was thrown", message, exception), type, location);
+                return false;
+            }
+        }
+
+        template<IsInvocable<void> Invocable>
+        bool CheckAnyThrow(Invocable invocable, const std::string_view message, const EFailType type,
+            const std::source_location location = std::source_location::current())
+        {
+            Reached(location);
+            try
+            {
+                invocable();
+                HandleFailure(std::format("Expression '{}' should throw exception", message), type, location);
+                return false;
+            }
+            catch(...)
+            {
+                return true;
+            }
+        }
+
+        template<IsInvocable<void> Invocable>
+        bool CheckNoThrow(Invocable invocable, const std::string_view message, const EFailType type,
+            const std::source_location location = std::source_location::current())
+        {
+            Reached(location);
+            try
+            {
+                invocable();
+                return true;
+            }
+            catch(...)
+            {
+                HandleFailure(std::format("Expression '{}' should not throw exception", message), type, location);
+                return false;
+            }
+        }
+
+        bool CheckCustom(const CheckResult& result, const EFailType type, const std::source_location location = std::source_location::current())
+        {
+            Reached(location);
+            if( !result.has_value() ) [[likely]]
+            {
+                return true;
+            }
+            HandleFailure(result.value(), type, location);
+            return false;
+        }
+
+        template<IsInvocable<void> Invocable>
+        bool CheckMaxAllocations(Invocable invocable, const std::uint64_t max, const std::string_view message, const EFailType type,
+            const std::source_location location = std::source_location::current())
+        {
+            Reached(location);
+            static_assert(Details::TrackAllocations || sizeof(Invocable) == 0uz, "Define MTEST_CONFIG_TRACK_ALLOCATIONS to check allocations");
+            if( !Details::AllocationTrackerInstalled )
+            {
+                HandleFailure(std::format("Allocations of statement '{}' can not be checked, use MTEST_ALLOCATION_TRACKER at global scope with own main()",
+                    message), type, location);
+                return false;
+            }
+            const std::uint64_t before = Details::Allocations.Count;
+            invocable();
+            const std::uint64_t count = Details::Allocations.Count - before;
+            if( count <= max ) [[likely]]
+            {
+                return true;
+            }
+            HandleFailure(std::format("Statement '{}' made {} allocations but at most {} are allowed", message, count, max), type, location);
+            return false;
+        }
+
+        void Fail(const std::string_view reason, bool stop, const std::source_location location = std::source_location::current())
+        {
+            Reached(location);
+            HandleFailure(reason, stop ? EFailType::Assert : EFailType::Check, location);
+        }
+
+        void Skip(const std::string& reason)
+        {
+            const Details::CAllocationPause pause{};
+            MarkSkipped();
+            SkipReason = reason;
+            GetLog().Write(EConsoleColor::Magenta, "[Skipped] {}\n", reason);
+            throw CTestSkippedException{};
+        }
+
+        void PrintResult(const bool isCompact) const
+        {
+            if( isCompact )
+            {
+                std::string metrics{};
+                if( Allocations )
+                {
+                    metrics += std::format(" [Allocations: {}, Bytes: {}, Peak: {}]", Allocations->Count, Allocations->Bytes, Allocations->Peak);
+                }
+                if( PerfCounters )
+                {
+                    metrics += std::format(" [{}]", Details::FormatPerfCounters(*PerfCounters));
+                }
+                GetLog().Write(Details::TestResultToColor(Result), "{} {} {}{}\n", Details::TestResultToString(Result),
+                    GetFullname(), Details::FormatTime(Duration), metrics);
+            }
+            else
+            {
+                GetLog().Write(Details::TestResultToColor(Result), "{} {} in File: {}, Line: {}\n", Details::TestResultToString(Result),
+                    GetFullname(), GetFile(), GetLine());
+            }
+        }
+    private:
+        void MarkFailed() { Result = ETestResult::Fail; }
+        void MarkSkipped() { Result = ETestResult::Skip; }
+
+        /// Run fixture made by given function, fixture lives only for duration of test case.
+        template<IsInvocable<FixtureWrapperPtr> MakeFixture>
+        void RunFixture(MakeFixture makeFixture)
+        {
+            FixtureWrapperPtr fixture{};
+            bool needCleanup{false};
+            StartWatch(Details::DefaultTimeout);
+            std::optional<Details::CTraceScope> setupTrace{std::in_place, "Setup", "setup"};
+            Runner([&]()
+            {
+                Details::AcquireSharedFixtures(Section);
+                {
+                    // Fixture is made by framework, only its Setup and test body are counted
+                    const Details::CAllocationPause pause{};
+                    fixture = makeFixture();
+                }
+                if( const auto timeout = fixture->MTest_Timeout(); timeout > std::chrono::milliseconds{0} )
+                {
+                    StartWatch(timeout);
+                }
+                if( fixture->MTest_Skip() )
+                {
+                    Skip("Test case is skipped by Fixture");
+                }
+                // Setup test case
+                needCleanup = true;
+                fixture->MTest_Setup();
+                setupTrace.reset();
+                //
+                const Details::CTraceScope trace{"Run", "run"};
+                const Details::CPerfScope perf{PerfCounters};
+                fixture->MTest_Run();
+            });
+            setupTrace.reset();
+            // Clear if needed
+            if( needCleanup )
+            {
+                const Details::CTraceScope trace{"Cleanup", "cleanup"};
+                Runner([&]()
+                {
+                    fixture->MTest_Cleanup();
+                });
+            }
+            StopWatch();
+        }
+
+        /// Watch test case with given time limit from now, zero means no limit.
+        void StartWatch(const std::chrono::milliseconds timeout)
+        {
+            Watch.File.store(nullptr, std::memory_order_relaxed);
+            if( timeout > std::chrono::milliseconds{0} )
+            {
+                // Watchdog thread and its entries are created on first use and outlive test case
+                const Details::CAllocationPause pause{};
+                Details::GetWatchdog().Arm(Watch, timeout);
+            }
+        }
+
+        /// Stop watching test case, it fails if watchdog has seen it running over its limit.
+        void StopWatch()
+        {
+            if( !Watch.Armed )
+            {
+                return;
+            }
+            Details::GetWatchdog().Disarm(Watch);
+            if( Watch.Expired.exchange(false, std::memory_order_relaxed) )
+            {
+                const Details::CAllocationPause pause{};
+                MarkFailed();
+                const std::string message = Details::FormatTimeout(Watch, Watch.Timeout);
+                Failures.push_back({EFailType::Fatal, message, {}, 0u});
+                GetLog().Write(EConsoleColor::Red, "{} {}\n", Details::FailTypeToString(EFailType::Fatal), message);
+            }
+        }
+
+        /// Remember location of assertion, so it can be reported when test case hangs. Without time limit it is only check of flag,
+        /// which is written by thread of test case before it runs body.
+        void Reached(const std::source_location location)
+        {
+            if( Watch.Armed )
+            {
+                Watch.File.store(location.file_name(), std::memory_order_relaxed);
+                Watch.Line.store(location.line(), std::memory_order_relaxed);
+            }
+        }
+
+        /// Name row of failed generated table test case, it is known only when row is made.
+        void ReportRow(const std::string& rowName)
+        {
+            const Details::CAllocationPause pause{};
+            GetLog().Write(EConsoleColor::Red, "[Row    ] {} failed for row '{}'\n", GetFullname(), rowName);
+            for(auto& i: Failures)
+            {
+                i.Message = std::format("[{}] {}", rowName, i.Message);
+            }
+        }
+
+        void HandleFailure(const std::string_view message, const EFailType type, const std::source_location location)
+        {
+            const Details::CAllocationPause pause{};
+            {
+                // Failures can be reported by several MTEST_CONCURRENT threads at once.
+                const std::lock_guard lock{FailureMutex};
+                MarkFailed();
+                const std::string file = Details::FilenameFromPath(location.file_name());
+                const std::string text = Details::ActiveThread == Details::NO_THREAD ? std::string{message} :
+                    std::format("[Thread {}] {}", Details::ActiveThread, message);
+                Failures.push_back({type, text, file, location.line()});
+                Details::TraceInstant(text, "failure");
+                GetLog().Write(EConsoleColor::Red, "{} {} in File: {}, Line: {}\n", Details::FailTypeToString(type), text,
+                    file, location.line());
+            }
+            if( type == EFailType::Assert )
+            {
+                throw CTestAssertionException{};
+            }
+        }
+
+        /// Start counting allocations of test case, peak is measured from live bytes at start.
+        Details::AllocationCounters BeginAllocations() const
+        {
+            Details::Allocations.Peak = Details::Allocations.Live;
+            return Details::Allocations;
+        }
+
+        /// Store allocations made since BeginAllocations, memory which is still live after Cleanup is reported as leak.
+        /// Only net allocations of current thread are counted, memory freed by another thread is not subtracted.
+        void EndAllocations(const Details::AllocationCounters& start)
+        {
+            if constexpr( Details::TrackAllocations )
+            {
+                const auto& end = Details::Allocations;
+                AllocationStats stats{};
+                stats.Count = end.Count - start.Count;
+                stats.Bytes = end.Bytes - start.Bytes;
+                stats.Peak = static_cast<std::uint64_t>(std::max<std::int64_t>(end.Peak - start.Live, 0));
+                stats.Leaked = static_cast<std::uint64_t>(std::max<std::int64_t>(end.Live - start.Live, 0));
+                stats.LeakedCount = static_cast<std::uint64_t>(std::max<std::int64_t>(end.LiveCount - start.LiveCount, 0));
+                Allocations = stats;
+                if( stats.Leaked > 0u )
+                {
+                    const Details::CAllocationPause pause{};
+                    MarkFailed();
+                    const std::string message = std::format("Test case leaked {} bytes in {} allocations", stats.Leaked, stats.LeakedCount);
+                    Failures.push_back({EFailType::Check, message, File, Line});
+                    GetLog().Write(EConsoleColor::Red, "{} {} in File: {}, Line: {}\n", Details::FailTypeToString(EFailType::Check), message,
+                        File, Line);
+                }
+            }
+        }
+
+        void HandleException(const std::string& what)
+        {
+            const Details::CAllocationPause pause{};
+            MarkFailed();
+            Failures.push_back({EFailType::Fatal, what, {}, 0u});
+            Details::TraceInstant(what, "failure");
+            GetLog().Write(EConsoleColor::Red, "{} {}\n", Details::FailTypeToString(EFailType::Fatal), what);
+            GetLog().Flush();
+        }
+
+        template<IsInvocable<void> Invocable>
+        void Runner(Invocable invocable)
+        {
+            try
+            {
+                invocable();
+            }
+            catch(const CTestAssertionException&) {}
+            catch(const CTestSkippedException&) {}
+            catch(const std::exception& e)
+            {
+                HandleException(e.what());
+            }
+            catch(...)
+            {
+                HandleException("Unknown exception was thrown");
+            }
+        }
+    private:
+        std::string Section{};
+        std::string Name{};
+        std::string Fullname{};
+        std::string File{};
+        std::string Path{};
+        std::uint_least32_t Line{};
+        ETestResult Result{ETestResult::Success};
+        FixtureFactory Factory{};
+        float Duration{0.0f}; // In miliseconds
+        std::vector<TestFailure> Failures{};
+        std::mutex FailureMutex{};
+        std::string SkipReason{};
+        std::optional<BenchmarkStats> Benchmark{};
+        std::optional<AllocationStats> Allocations{};
+        std::optional<PerfCounterStats> PerfCounters{};
+        LogBuffer Output{};
+        TraceBuffer Trace{};
+        std::atomic<bool> Finished{false};
+        bool Async{false};
+        bool GeneratedRow{false};
+        TestClockStamp AsyncStart{};
+        Details::WatchState Watch{};
+    };
+
+    namespace Details
+    {
+        /// Pending operation of suspended coroutine, it lives in awaiter while coroutine is suspended.
+        struct AsyncWaiter
+        {
+            std::coroutine_handle<> Handle{};
+            CTestCase* Test{};
+            bool Cancelled{false};
+        };
+
+        /// Single threaded event loop which runs coroutines of async test cases, on Linux it waits with epoll and timerfd.
+        /// When it runs several test cases, active test case and output capture are switched to owner of each resumed coroutine.
+        /// Test case which runs over its time limit is cancelled: its pending operations throw, so its Cleanup still runs.
+        class CEventLoop final
+        {
+            using LoopClock = std::chrono::steady_clock;
+
+            struct Timer
+            {
+                LoopClock::time_point Deadline{};
+                std::uint64_t Sequence{0u};
+                AsyncWaiter* Waiter{};
+
+                bool operator>(const Timer& other) const
+                {
+                    return Deadline != other.Deadline ? Deadline > other.Deadline : Sequence > other.Sequence;
+                }
+            };
+
+            struct FdWaiters
+            {
+                AsyncWaiter* Read{};
+                AsyncWaiter* Write{};
+            };
+
+            struct Root
+            {
+                Task Coroutine{};
+                CTestCase* Test{};
+            };
+        public:
+            /// When switchTests is set, each coroutine is resumed as its own test case with its output captured.
+            explicit CEventLoop(const bool switchTests):
+                SwitchTests(switchTests)
+            {
+            #ifdef MTEST_LINUX_PLATFORM
+                Poll = epoll_create1(EPOLL_CLOEXEC);
+                TimerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+                if( Poll < 0 || TimerFd < 0 )
+                {
+                    throw std::runtime_error(std::format("Unable to create event loop: {}", strerror(errno)));
+                }
+                epoll_event event{};
+                event.events = EPOLLIN;
+                event.data.fd = TimerFd;
+                epoll_ctl(Poll, EPOLL_CTL_ADD, TimerFd, &event);
+            #endif
+            }
+            CEventLoop(const CEventLoop&) = delete;
+            CEventLoop(CEventLoop&&) = delete;
+            ~CEventLoop()
+            {
+                Roots.clear();
+            #ifdef MTEST_LINUX_PLATFORM
+                close(TimerFd);
+                close(Poll);
+            #endif
+            }
+
+            CEventLoop& operator=(const CEventLoop&) = delete;
+            CEventLoop& operator=(CEventLoop&&) = delete;
+
+            /// Loop which runs on calling thread, null outside of async test case.
+            static CEventLoop* GetActive() { return Active; }
+
+            /// Add coroutine which is started when loop runs.
+            void Spawn(Task coroutine, CTestCase* test)
+            {
+                Ready.push_back(Waiters.emplace_back(std::make_unique<AsyncWaiter>(coroutine.GetHandle(), test)).get());
+                Roots.push_back({std::move(coroutine), test});
+            }
+
+            /// Run until all spawned coroutines are done. Exception which has ended root coroutine is rethrown.
+            void Run()
+            {
+                // Previous loop is restored also when AbortSuspended or Wait throws
+                struct ActiveScope
+                {
+                    CEventLoop* Previous{};
+                    ~ActiveScope() { Active = Previous; }
+                } scope{std::exchange(Active, this)};
+                std::exception_ptr error{};
+                while( !Roots.empty() )
+                {
+                    while( !Ready.empty() )
+                    {
+                        AsyncWaiter* waiter = Ready.front();
+                        Ready.pop_front();
+                        Resume(*waiter);
+                    }
+                    for(auto i = Roots.begin(); i != Roots.end();)
+                    {
+                        if( i->Coroutine.IsDone() )
+                        {
+                            try
+                            {
+                                i->Coroutine.Rethrow();
+                            }
+                            catch(...)
+                            {
+                                error = std::current_exception();
+                            }
+                            i = Roots.erase(i);
+                            continue;
+                        }
+                        if( i->Test && i->Test->IsTimedOut() && !Cancelled.contains(i->Test) )
+                        {
+                            Cancel(i->Test);
+                        }
+                        ++i;
+                    }
+                    if( Roots.empty() || !Ready.empty() )
+                    {
+                        continue;
+                    }
+                    if( Timers.empty() && Fds.empty() )
+                    {
+                        AbortSuspended();
+                        continue;
+                    }
+                    Wait();
+                }
+                if( error )
+                {
+                    std::rethrow_exception(error);
+                }
+            }
+
+            void Schedule(AsyncWaiter& waiter)
+            {
+                Ready.push_back(&waiter);
+            }
+
+            void AddTimer(const LoopClock::time_point deadline, AsyncWaiter& waiter)
+            {
+                Timers.push_back({deadline, NextSequence++, &waiter});
+                std::ranges::push_heap(Timers, std::greater{});
+            }
+
+            /// Resume waiter when file descriptor is readable or writable, only one waiter of each kind per descriptor.
+            void AddFd(const int fd, const bool write, AsyncWaiter& waiter)
+            {
+            #ifdef MTEST_LINUX_PLATFORM
+                const auto [it, inserted] = Fds.try_emplace(fd);
+                AsyncWaiter*& slot = write ? it->second.Write : it->second.Read;
+                if( slot )
+                {
+                    throw std::logic_error(std::format("File descriptor {} is already awaited", fd));
+                }
+                slot = &waiter;
+                if( !UpdateFd(fd, inserted ? EPOLL_CTL_ADD : EPOLL_CTL_MOD) )
+                {
+                    slot = nullptr;
+                    if( inserted )
+                    {
+                        Fds.erase(fd);
+                    }
+                    throw std::runtime_error(std::format("Unable to wait for file descriptor {}: {}", fd, strerror(errno)));
+                }
+            #else
+                std::ignore = fd;
+                std::ignore = write;
+                std::ignore = waiter;
+                throw std::logic_error("Waiting for file descriptor is not supported on this platform");
+            #endif
+            }
+
+            /// Cancelled test case does not wait anymore, its pending and next operations throw.
+            bool IsCancelled(const CTestCase* test) const { return test && Cancelled.contains(test); }
+        private:
+            void Resume(AsyncWaiter& waiter)
+            {
+                if( !SwitchTests )
+                {
+                    waiter.Handle.resume();
+                    return;
+                }
+                CTestCase* previousTest = std::exchange(ActiveTest, waiter.Test);
+                TraceBuffer* previousTrace = std::exchange(ActiveTrace, CollectTrace ? &waiter.Test->GetTrace() : nullptr);
+                LogBuffer* previousCapture = GetLog().SetCapture(&waiter.Test->GetOutput());
+                waiter.Handle.resume();
+                GetLog().SetCapture(previousCapture);
+                ActiveTrace = previousTrace;
+                ActiveTest = previousTest;
+            }
+
+            void Cancel(CTestCase* test)
+            {
+                Cancelled.insert(test);
+                const auto cancel = [&](AsyncWaiter* waiter)
+                {
+                    if( waiter && waiter->Test == test )
+                    {
+                        waiter->Cancelled = true;
+                        Ready.push_back(waiter);
+                        return true;
+                    }
+                    return false;
+                };
+                if( std::erase_if(Timers, [&](const Timer& i) { return cancel(i.Waiter); }) > 0uz )
+                {
+                    std::ranges::make_heap(Timers, std::greater{});
+                }
+                for(auto i = Fds.begin(); i != Fds.end();)
+                {
+                    const int fd = i->first;
+                    if( cancel(i->second.Read) )
+                    {
+                        i->second.Read = nullptr;
+                    }
+                    if( cancel(i->second.Write) )
+                    {
+                        i->second.Write = nullptr;
+                    }
+                    i = UpdateWaiters(i, fd);
+                }
+            }
+
+            /// Nothing can resume remaining coroutines, they are destroyed and their test cases fail.
+            void AbortSuspended()
+            {
+                for(auto& i: Roots)
+                {
+                    if( !SwitchTests )
+                    {
+                        i.Coroutine = Task{};
+                    }
+                    else
+                    {
+                        CTestCase* previousTest = std::exchange(ActiveTest, i.Test);
+                        TraceBuffer* previousTrace = std::exchange(ActiveTrace, CollectTrace ? &i.Test->GetTrace() : nullptr);
+                        LogBuffer* previousCapture = GetLog().SetCapture(&i.Test->GetOutput());
+                        i.Coroutine = Task{};
+                        i.Test->AbortSuspended();
+                        GetLog().SetCapture(previousCapture);
+                        ActiveTrace = previousTrace;
+                        ActiveTest = previousTest;
+                    }
+                }
+                if( !SwitchTests && !Roots.empty() )
+                {
+                    Roots.clear();
+                    throw std::runtime_error("Async test case is suspended, but it does not wait for any MTest operation");
+                }
+                Roots.clear();
+            }
+
+            /// Sleep until nearest timer or file descriptor event, wake up regularly when test case can time out.
+            void Wait()
+            {
+                const bool watched = std::ranges::any_of(Roots, [](const Root& i) { return i.Test && i.Test->IsWatched(); });
+                auto wake = Timers.empty() ? LoopClock::time_point::max() : Timers.front().Deadline;
+                if( watched )
+                {
+                    wake = std::min(wake, LoopClock::now() + std::chrono::milliseconds{10});
+                }
+            #ifdef MTEST_LINUX_PLATFORM
+                itimerspec timer{};
+                if( wake != LoopClock::time_point::max() )
+                {
+                    const auto ns = std::max<std::int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(wake.time_since_epoch()).count(), 1);
+                    timer.it_value.tv_sec = static_cast<time_t>(ns / 1000000000);
+                    timer.it_value.tv_nsec = static_cast<long>(ns % 1000000000);
+                }
+                // Steady clock is CLOCK_MONOTONIC, so its time is used as absolute deadline.
+                timerfd_settime(TimerFd, TFD_TIMER_ABSTIME, &timer, nullptr);
+                std::array<epoll_event, 64uz> events{};
+                const int count = epoll_wait(Poll, events.data(), static_cast<int>(events.size()), -1);
+                for(int i{0}; i < count; ++i)
+                {
+                    const auto& event = events[static_cast<std::size_t>(i)];
+                    if( event.data.fd == TimerFd )
+                    {
+                        std::uint64_t expirations{0u};
+                        std::ignore = read(TimerFd, &expirations, sizeof(expirations));
+                        continue;
+                    }
+                    const auto it = Fds.find(event.data.fd);
+                    if( it == Fds.end() )
+                    {
+                        continue;
+                    }
+                    // Errors and hang up wake both kinds of waiters, the operation itself reports them.
+                    const bool failed = (event.events & (EPOLLERR | EPOLLHUP)) != 0u;
+                    if( it->second.Read && (failed || (event.events & EPOLLIN) != 0u) )
+                    {
+                        Ready.push_back(std::exchange(it->second.Read, nullptr));
+                    }
+                    if( it->second.Write && (failed || (event.events & EPOLLOUT) != 0u) )
+                    {
+                        Ready.push_back(std::exchange(it->second.Write, nullptr));
+                    }
+                    UpdateWaiters(it, event.data.fd);
+                }
+            #else
+                if( wake != LoopClock::time_point::max() )
+                {
+                    std::this_thread::sleep_until(wake);
+                }
+            #endif
+                const auto now = LoopClock::now();
+                while( !Timers.empty() && Timers.front().Deadline <= now )
+                {
+                    Ready.push_back(Timers.front().Waiter);
+                    std::ranges::pop_heap(Timers, std::greater{});
+                    Timers.pop_back();
+                }
+            }
+
+            /// Update interest of descriptor after its waiters have changed, returns next descriptor.
+            std::unordered_map<int, FdWaiters>::iterator UpdateWaiters(const std::unordered_map<int, FdWaiters>::iterator it, const int fd)
+            {
+                if( !it->second.Read && !it->second.Write )
+                {
+                #ifdef MTEST_LINUX_PLATFORM
+                    epoll_ctl(Poll, EPOLL_CTL_DEL, fd, nullptr);
+                #endif
+                    return Fds.erase(it);
+                }
+                std::ignore = UpdateFd(fd, EPOLL_CTL_MOD);
+                return std::next(it);
+            }
+
+            bool UpdateFd(const int fd, const int operation)
+            {
+            #ifdef MTEST_LINUX_PLATFORM
+                const auto& waiters = Fds.at(fd);
+                epoll_event event{};
+                event.events = (waiters.Read ? EPOLLIN : 0u) | (waiters.Write ? EPOLLOUT : 0u);
+                event.data.fd = fd;
+                return epoll_ctl(Poll, operation, fd, &event) == 0;
+            #else
+                std::ignore = fd;
+                std::ignore = operation;
+                return false;
+            #endif
+            }
+        private:
+            static constinit inline thread_local CEventLoop* Active{nullptr};
+
+            bool SwitchTests{false};
+            std::deque<AsyncWaiter*> Ready{};
+            std::vector<Timer> Timers{};
+            std::uint64_t NextSequence{0u};
+            std::unordered_map<int, FdWaiters> Fds{};
+            std::unordered_set<const CTestCase*> Cancelled{};
+            std::vector<std::unique_ptr<AsyncWaiter>> Waiters{}; // Waiters of root coroutines
+            std::list<Root> Roots{};
+        #ifdef MTEST_LINUX_PLATFORM
+            int Poll{-1};
+            int TimerFd{-1};
+        #endif
+        };
+
+        /// Base of awaiters of event loop operations.
+        class CLoopAwaiter
+        {
+        public:
+            CLoopAwaiter():
+                Loop(CEventLoop::GetActive())
+            {
+                if( !Loop )
+                {
+                    throw std::logic_error("MTest async operation must be awaited inside async test case");
+                }
+            }
+
+            bool await_ready() const noexcept { return false; }
+            bool await_suspend(const std::coroutine_handle<> handle)
+            {
+                Waiter.Handle = handle;
+                Waiter.Test = ActiveTest;
+                if( Loop->IsCancelled(Waiter.Test) )
+                {
+                    Waiter.Cancelled = true;
+                    return false;
+                }
+                Register();
+                return true;
+            }
+            void await_resume() const
+            {
+                if( Waiter.Cancelled )
+                {
+                    // Failure is reported by watchdog, test case is only unwound to its Cleanup.
+                    throw CTestAssertionException{};
+                }
+            }
+        protected:
+            ~CLoopAwaiter() = default;
+            virtual void Register() = 0;
+        protected:
+            CEventLoop* Loop{};
+            AsyncWaiter Waiter{};
+        };
+
+        class CSleepAwaiter final: public CLoopAwaiter
+        {
+        public:
+            explicit CSleepAwaiter(const std::chrono::steady_clock::time_point deadline):
+                Deadline(deadline)
+            {
+            }
+        private:
+            void Register() override { Loop->AddTimer(Deadline, Waiter); }
+        private:
+            std::chrono::steady_clock::time_point Deadline{};
+        };
+
+        class CYieldAwaiter final: public CLoopAwaiter
+        {
+        private:
+            void Register() override { Loop->Schedule(Waiter); }
+        };
+
+        class CFdAwaiter final: public CLoopAwaiter
+        {
+        public:
+            CFdAwaiter(const int fd, const bool write):
+                Fd(fd),
+                IsWrite(write)
+            {
+            }
+        private:
+            void Register() override { Loop->AddFd(Fd, IsWrite, Waiter); }
+        private:
+            int Fd{-1};
+            bool IsWrite{false};
+        };
+
+        /// Run body of async test case on its own loop, used when test case is not run together with others, eg. in isolated worker.
+        inline void RunTask(Task task)
+        {
+            CEventLoop loop{false};
+            loop.Spawn(std::move(task), ActiveTest);
+            loop.Run();
+        }
+    }
+
+    /// Suspend async test case for given time, other async test cases run meanwhile.
+    template<class Rep, class Period>
+    Details::CSleepAwaiter SleepFor(const std::chrono::duration<Rep, Period> duration)
+    {
+        return Details::CSleepAwaiter{std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(duration)};
+    }
+
+    /// Let other async test cases run.
+    inline Details::CYieldAwaiter Yield() { return {}; }
+
+    /// Suspend async test case until file descriptor is readable, or it has error. Supported on Linux.
+    inline Details::CFdAwaiter WaitReadable(const int fd) { return {fd, false}; }
+
+    /// Suspend async test case until file descriptor is writable, or it has error. Supported on Linux.
+    inline Details::CFdAwaiter WaitWritable(const int fd) { return {fd, true}; }
+
+    namespace Details
+    {
+        /// Runs tasks on fixed number of threads. Each worker takes tasks from the front of its own queue,
+        /// idle worker steals from the back of other queues.
+        class CWorkStealingPool final
+        {
+            struct WorkerQueue
+            {
+                std::mutex Mutex{};
+                std::deque<std::size_t> Tasks{};
+            };
+        public:
+            /// Called with worker index and task index.
+            using TaskFunction = std::function<void(std::size_t, std::size_t)>;
+            /// Called on worker thread when it has no more tasks.
+            using ExitFunction = std::function<void()>;
+
+            /// Tasks are indices in range [0, taskCount). When schedule of all tasks is given, tasks are packed longest first
+            /// to the least loaded worker, otherwise each worker gets contiguous block.
+            CWorkStealingPool(const std::size_t workerCount, const std::size_t taskCount, TaskFunction task, ExitFunction onExit = {},
+                const std::vector<ScheduledTask>& schedule = {}):
+                Task(std::move(task)),
+                OnExit(std::move(onExit))
+            {
+                for(std::size_t i{0uz}; i < workerCount; ++i)
+                {
+                    Queues.push_back(std::make_unique<WorkerQueue>());
+                }
+                if( schedule.size() == taskCount )
+                {
+                    // Longest tasks are at front, so stolen tasks from back are short.
+                    const auto bins = PackLongestFirst(schedule, workerCount);
+                    for(std::size_t i{0uz}; i < schedule.size(); ++i)
+                    {
+                        Queues[bins[i]]->Tasks.push_back(schedule[i].Index);
+                    }
+                }
+                else
+                {
+                    for(std::size_t i{0uz}; i < workerCount; ++i)
+                    {
+                        // Contiguous blocks, so tasks mostly finish in order in which they are reported.
+                        const std::size_t begin = taskCount * i / workerCount;
+                        const std::size_t end = taskCount * (i + 1uz) / workerCount;
+                        for(std::size_t j{begin}; j < end; ++j)
+                        {
+                            Queues[i]->Tasks.push_back(j);
+                        }
+                    }
+                }
+                for(std::size_t i{0uz}; i < workerCount; ++i)
+                {
+                    Threads.emplace_back([this, i]() { WorkerLoop(i); });
+                }
+            }
+            CWorkStealingPool(const CWorkStealingPool&) = delete;
+            CWorkStealingPool(CWorkStealingPool&&) = delete;
+            ~CWorkStealingPool() { Join(); }
+
+            CWorkStealingPool& operator=(const CWorkStealingPool&) = delete;
+            CWorkStealingPool& operator=(CWorkStealingPool&&) = delete;
+
+            /// Wait until all tasks are done.
+            void Join()
+            {
+                for(auto& i: Threads)
+                {
+                    if( i.joinable() )
+                    {
+                        i.join();
+                    }
+                }
+            }
+        private:
+            std::optional<std::size_t> Pop(const std::size_t worker)
+            {
+                auto& queue = *Queues[worker];
+                const std::lock_guard lock{queue.Mutex};
+                if( queue.Tasks.empty() )
+                {
+                    return std::nullopt;
+                }
+                const std::size_t task = queue.Tasks.front();
+                queue.Tasks.pop_front();
+                return task;
+            }
+
+            std::optional<std::size_t> Steal(const std::size_t thief)
+            {
+                for(std::size_t i{1uz}; i < Queues.size(); ++i)
+                {
+                    auto& queue = *Queues[(thief + i) % Queues.size()];
+                    const std::lock_guard lock{queue.Mutex};
+                    if( !queue.Tasks.empty() )
+                    {
+                        const std::size_t task = queue.Tasks.back();
+                        queue.Tasks.pop_back();
+                        return task;
+                    }
+                }
+                return std::nullopt;
+            }
+
+            void WorkerLoop(const std::size_t worker)
+            {
+                // No tasks are added after start, so when nothing can be stolen all work is taken.
+                while( true )
+                {
+                    auto task = Pop(worker);
+                    if( !task )
+                    {
+                        task = Steal(worker);
+                    }
+                    if( !task )
+                    {
+                        break;
+                    }
+                    Task(worker, *task);
+                }
+                if( OnExit )
+                {
+                    OnExit();
+                }
+            }
+        private:
+            TaskFunction Task{};
+            ExitFunction OnExit{};
+            std::vector<std::unique_ptr<WorkerQueue>> Queues{};
+            std::vector<std::thread> Threads{};
+        };
+    }
+
+    /// Streams JUnit XML report, each test case is written as soon as it is reported.
+    class CJUnitSink final: public ISink
+    {
+    public:
+        CJUnitSink(const std::string& path):
+            Handle(std::fopen(path.c_str(), "w"))
+        {
+        }
+
+        ~CJUnitSink()
+        {
+            if( Handle )
+            {
+                std::fclose(Handle);
+                Handle = nullptr;
+            }
+        }
+
+        /// False when report file could not be opened, nothing is written then.
+        bool IsOpen() const { return Handle != nullptr; }
+
+        void SetColor(const EConsoleColor) override {}
+        void Write(const std::string&) override {}
+
+        void Flush() override
+        {
+            if( Handle )
+            {
+                std::fflush(Handle);
+            }
+        }
+
+        void OnRunStart() override
+        {
+            Print("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<testsuites>\n");
+            RunOpen = true;
+        }
+
+        void OnSectionStart(const std::string& section) override
+        {
+            Print(std::format("  <testsuite name=\"{}\">\n", Details::EscapeXml(section)));
+            SectionOpen = true;
+        }
+
+        void OnTestReport(const CTestCase& testCase) override
+        {
+            TestOpen = true;
+            Print(std::format("    <testcase classname=\"{}\" name=\"{}\" file=\"{}\" line=\"{}\" time=\"{:.6f}\">\n",
+                Details::EscapeXml(testCase.GetSection()), Details::EscapeXml(testCase.GetName()), Details::EscapeXml(testCase.GetFile()),
+                testCase.GetLine(), testCase.GetDuration() / 1000.0f));
+        }
+
+        void OnTestFailure(const CTestCase&, const TestFailure& failure) override
+        {
+            const std::string location = failure.File.empty() ? std::string{} : std::format("File: {}, Line: {}", failure.File, failure.Line);
+            Print(std::format("      <{} message=\"{}\" type=\"{}\">{}</{}>\n", failure.Type == EFailType::Fatal ? "error" : "failure",
+                Details::EscapeXml(failure.Message), Details::FailTypeToName(failure.Type), Details::EscapeXml(location),
+                failure.Type == EFailType::Fatal ? "error" : "failure"));
+        }
+
+        void OnTestEnd(const CTestCase& testCase) override
+        {
+            if( testCase.IsSkipped() )
+            {
+                Print(std::format("      <skipped message=\"{}\"/>\n", Details::EscapeXml(testCase.GetSkipReason())));
+            }
+            Print("    </testcase>\n");
+            TestOpen = false;
+        }
+
+        void OnSectionEnd(const std::string&) override
+        {
+            Print("  </testsuite>\n");
+            SectionOpen = false;
+        }
+
+        void OnRunEnd(const RunSummary&) override
+        {
+            Print("</testsuites>\n");
+            Flush();
+        }
+
+        void OnRunAbort(const std::string& reason) override
+        {
+            if( !RunOpen )
+            {
+                return;
+            }
+            if( TestOpen )
+            {
+                Print("    </testcase>\n");
+            }
+            if( SectionOpen )
+            {
+                Print("  </testsuite>\n");
+            }
+            Print(std::format("  <testsuite name=\"Aborted\">\n    <testcase classname=\"Aborted\" name=\"Run\" time=\"0\">\n"
+                "      <error message=\"{}\" type=\"fatal\"></error>\n    </testcase>\n  </testsuite>\n</testsuites>\n", Details::EscapeXml(reason)));
+            // Events reported after abort would break closed report.
+            std::fclose(Handle);
+            Handle = nullptr;
+        }
+    private:
+        void Print(const std::string& text)
+        {
+            if( Handle )
+            {
+                std::fwrite(text.data(), 1uz, text.size(), Handle);
+            }
+        }
+    private:
+        std::FILE* Handle{};
+        bool RunOpen{false};
+        bool SectionOpen{false};
+        bool TestOpen{false};
+    };
+
+    /// Streams JSON Lines report, each event is one JSON object in separate line.
+    class CJsonLinesSink final: public ISink
+    {
+    public:
+        CJsonLinesSink(const std::string& path):
+            Handle(std::fopen(path.c_str(), "w"))
+        {
+        }
+
+        ~CJsonLinesSink()
+        {
+            if( Handle )
+            {
+                std::fclose(Handle);
+                Handle = nullptr;
+            }
+        }
+
+        /// False when report file could not be opened, nothing is written then.
+        bool IsOpen() const { return Handle != nullptr; }
+
+        void SetColor(const EConsoleColor) override {}
+        void Write(const std::string&) override {}
+
+        void Flush() override
+        {
+            if( Handle )
+            {
+                std::fflush(Handle);
+            }
+        }
+
+        void OnRunStart() override
+        {
+            Print("{\"event\":\"run_start\"}\n");
+        }
+
+        void OnSectionStart(const std::string& section) override
+        {
+            Print(std::format("{{\"event\":\"section_start\",\"section\":\"{}\"}}\n", Details::EscapeJson(section)));
+        }
+
+        void OnTestReport(const CTestCase& testCase) override
+        {
+            Print(std::format("{{\"event\":\"test_report\",\"test\":\"{}\",\"section\":\"{}\",\"name\":\"{}\",\"file\":\"{}\",\"line\":{}}}\n",
+                Details::EscapeJson(testCase.GetFullname()), Details::EscapeJson(testCase.GetSection()), Details::EscapeJson(testCase.GetName()),
+                Details::EscapeJson(testCase.GetFile()), testCase.GetLine()));
+        }
+
+        void OnTestFailure(const CTestCase& testCase, const TestFailure& failure) override
+        {
+            Print(std::format("{{\"event\":\"failure\",\"test\":\"{}\",\"type\":\"{}\",\"message\":\"{}\",\"file\":\"{}\",\"line\":{}}}\n",
+                Details::EscapeJson(testCase.GetFullname()), Details::FailTypeToName(failure.Type), Details::EscapeJson(failure.Message),
+                Details::EscapeJson(failure.File), failure.Line));
+        }
+
+        void OnTestEnd(const CTestCase& testCase) override
+        {
+            std::string extra{};
+            if( testCase.IsSkipped() )
+            {
+                extra += std::format(",\"skip_reason\":\"{}\"", Details::EscapeJson(testCase.GetSkipReason()));
+            }
+            if( const auto& stats = testCase.GetBenchmarkStats(); stats )
+            {
+                extra += std::format(",\"benchmark\":{{\"iterations\":{},\"samples\":{},\"min_ns\":{},\"median_ns\":{},\"mean_ns\":{},\"stddev_ns\":{},\"p99_ns\":{}}}",
+                    stats->Iterations, stats->Samples, stats->Min, stats->Median, stats->Mean, stats->StdDev, stats->P99);
+            }
+            if( const auto& stats = testCase.GetAllocationStats(); stats )
+            {
+                extra += std::format(",\"allocations\":{{\"count\":{},\"bytes\":{},\"peak_bytes\":{},\"leaked_bytes\":{}}}",
+                    stats->Count, stats->Bytes, stats->Peak, stats->Leaked);
+            }
+            if( const auto& stats = testCase.GetPerfCounters(); stats )
+            {
+                std::string counters{};
+                for(const auto& i: Details::PerfCounterFields)
+                {
+                    if( (*stats).*i.Member )
+                    {
+                        counters += std::format("{}\"{}\":{}", counters.empty() ? "" : ",", i.Key, *((*stats).*i.Member));
+                    }
+                }
+                extra += std::format(",\"perf_counters\":{{{}}}", counters);
+            }
+            Print(std::format("{{\"event\":\"test_end\",\"test\":\"{}\",\"result\":\"{}\",\"duration_ms\":{}{}}}\n",
+                Details::EscapeJson(testCase.GetFullname()), Details::TestResultToName(testCase.GetResult()), testCase.GetDuration(), extra));
+        }
+
+        void OnSectionEnd(const std::string& section) override
+        {
+            Print(std::format("{{\"event\":\"section_end\",\"section\":\"{}\"}}\n", Details::EscapeJson(section)));
+        }
+
+        void OnRunEnd(const RunSummary& summary) override
+        {
+            Print(std::format("{{\"event\":\"run_end\",\"successful\":{},\"failed\":{},\"skipped\":{},\"duration_ms\":{}}}\n",
+                summary.Successful, summary.Failed, summary.Skipped, summary.Duration));
+            Flush();
+        }
+
+        void OnRunAbort(const std::string& reason) override
+        {
+            Print(std::format("{{\"event\":\"run_abort\",\"reason\":\"{}\"}}\n", Details::EscapeJson(reason)));
+            Flush();
+        }
+    private:
+        void Print(const std::string& text)
+        {
+            if( Handle )
+            {
+                std::fwrite(text.data(), 1uz, text.size(), Handle);
+            }
+        }
+    private:
+        std::FILE* Handle{};
+    };
+
+    /// Streams timeline in Chrome Trace Event Format, it can be opened in ui.perfetto.dev or chrome://tracing.
+    /// Each worker thread or process has its own track, events of test case are written when it is reported.
+    class CTraceSink final: public ISink
+    {
+    public:
+        CTraceSink(const std::string& path):
+            Handle(std::fopen(path.c_str(), "w")),
+            Origin(Details::TraceNow()),
+            MainProcess(Details::TraceTrack().first)
+        {
+            Print("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        }
+
+        ~CTraceSink()
+        {
+            Close();
+        }
+
+        /// False when report file could not be opened, nothing is written then.
+        bool IsOpen() const { return Handle != nullptr; }
+
+        void SetColor(const EConsoleColor) override {}
+        void Write(const std::string&) override {}
+
+        void Flush() override
+        {
+            if( Handle )
+            {
+                std::fflush(Handle);
+            }
+        }
+
+        void OnTestEnd(const CTestCase& testCase) override
+        {
+            for(const auto& i: testCase.GetTrace())
+            {
+                if( Tracks.insert((static_cast<std::uint64_t>(i.Process) << 32u) | i.Thread).second )
+                {
+                    NameTrack(i.Process, i.Thread);
+                }
+                const double start = static_cast<double>(i.Start - std::min(i.Start, Origin)) / 1000.0;
+                std::string event = std::format("{{\"name\":\"{}\",\"cat\":\"{}\",\"ph\":\"{}\",\"ts\":{:.3f},\"pid\":{},\"tid\":{}",
+                    Details::EscapeJson(i.Name), Details::EscapeJson(i.Category), i.Phase, start, i.Process, i.Thread);
+                if( i.Phase == 'X' )
+                {
+                    event += std::format(",\"dur\":{:.3f}", static_cast<double>(i.Duration) / 1000.0);
+                }
+                else
+                {
+                    event += ",\"s\":\"t\"";
+                }
+                event += std::format(",\"args\":{{\"test\":\"{}\"}}}}", Details::EscapeJson(testCase.GetFullname()));
+                PrintEvent(event);
+            }
+        }
+
+        void OnRunAbort(const std::string&) override
+        {
+            Close();
+        }
+    private:
+        void Close()
+        {
+            if( Handle )
+            {
+                Print("\n]}\n");
+                std::fclose(Handle);
+                Handle = nullptr;
+            }
+        }
+
+        void NameTrack(const std::uint32_t process, const std::uint32_t thread)
+        {
+            if( Processes.insert(process).second )
+            {
+                PrintEvent(std::format("{{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":{},\"tid\":0,\"args\":{{\"name\":\"{} {}\"}}}}",
+                    process, process == MainProcess ? "Test process" : "Worker process", process));
+            }
+            const std::string name = thread == 0u ? std::string{"Main thread"} : std::format("Worker thread {}", thread);
+            PrintEvent(std::format("{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":{},\"tid\":{},\"args\":{{\"name\":\"{}\"}}}}",
+                process, thread, name));
+        }
+
+        void PrintEvent(const std::string& event)
+        {
+            Print(First ? event : ",\n" + event);
+            First = false;
+        }
+
+        void Print(const std::string& text)
+        {
+            if( Handle )
+            {
+                std::fwrite(text.data(), 1uz, text.size(), Handle);
+            }
+        }
+    private:
+        std::FILE* Handle{};
+        std::uint64_t Origin{0u};
+        std::uint32_t MainProcess{0u};
+        bool First{true};
+        std::unordered_set<std::uint64_t> Tracks{};
+        std::unordered_set<std::uint32_t> Processes{};
+    };
+
+#ifdef MTEST_LINUX_PLATFORM
+    namespace Details
+    {
+        inline std::string SignalName(const int signal)
+        {
+            switch(signal)
+            {
+            case SIGSEGV:
+                return "SIGSEGV";
+            case SIGABRT:
+                return "SIGABRT";
+            case SIGBUS:
+                return "SIGBUS";
+            case SIGFPE:
+                return "SIGFPE";
+            case SIGILL:
+                return "SIGILL";
+            case SIGKILL:
+                return "SIGKILL";
+            case SIGTERM:
+                return "SIGTERM";
+            case SIGTRAP:
+                return "SIGTRAP";
+            case SIGPIPE:
+                return "SIGPIPE";
+            default:
+                return std::format("signal {}", signal);
+            }
+        }
+
+        /// Describe why worker process finished, status is from waitpid.
+        inline std::string ProcessStatusToString(const int status)
+        {
+            if( WIFSIGNALED(status) )
+            {
+                const int signal = WTERMSIG(status);
+                return std::format("Test process crashed with {} ({})", SignalName(signal), strsignal(signal));
+            }
+            if( WIFEXITED(status) )
+            {
+                return std::format("Test process exited with code {}", WEXITSTATUS(status));
+            }
+            return "Test process was lost";
+        }
+
+        inline bool ReadAll(const int fd, void* data, const std::size_t size)
+        {
+            auto* bytes = static_cast<char*>(data);
+            std::size_t done{0uz};
+            while( done < size )
+            {
+                const ssize_t result = read(fd, bytes + done, size - done);
+                if( result < 0 && errno == EINTR )
+                {
+                    continue;
+                }
+                if( result <= 0 )
+                {
+                    return false;
+                }
+                done += static_cast<std::size_t>(result);
+            }
+            return true;
+        }
+
+        inline bool WriteAll(const int fd, const void* data, const std::size_t size)
+        {
+            const auto* bytes = static_cast<const char*>(data);
+            std::size_t done{0uz};
+            while( done < size )
+            {
+                const ssize_t result = write(fd, bytes + done, size - done);
+                if( result < 0 && errno == EINTR )
+                {
+                    continue;
+                }
+                if( result <= 0 )
+                {
+                    return false;
+                }
+                done += static_cast<std::size_t>(result);
+            }
+            return true;
+        }
+
+        /// Runs tasks in long-lived forked worker processes, so crash of one task does not take down the whole run.
+        /// Tasks are sent over pipe, results are streamed back. Crashed worker is replaced by new one.
+        class CProcessPool final
+        {
+            using PoolClock = std::chrono::steady_clock;
+            /// Sent by worker instead of result size when its task was aborted, followed by reason.
+            static constexpr std::uint64_t ABORTED_TASK = std::numeric_limits<std::uint64_t>::max();
+
+            struct Worker
+            {
+                pid_t Pid{-1};
+                int CommandFd{-1};
+                int ResultFd{-1};
+                std::optional<std::size_t> Task{};
+                PoolClock::time_point Start{};
+            };
+        public:
+            /// Run task in worker process and return serialized result.
+            using TaskFunction = std::function<std::string(std::size_t)>;
+            /// Called in main process with task index and its serialized result.
+            using ResultFunction = std::function<void(std::size_t, std::string_view)>;
+            /// Called in main process when task did not finish, with reason and time in milliseconds.
+            using AbortFunction = std::function<void(std::size_t, const std::string&, float)>;
+            /// Called in worker process before it exits normally.
+            using ExitFunction = std::function<void()>;
+
+            /// Tasks are dispatched in order of schedule when it has all tasks, otherwise in order of their indices.
+            CProcessPool(const std::size_t workerCount, const std::size_t taskCount, TaskFunction task, ResultFunction onResult, AbortFunction onAbort,
+                ExitFunction onExit = {}, const std::vector<ScheduledTask>& schedule = {}):
+                TaskCount(taskCount),
+                Task(std::move(task)),
+                OnResult(std::move(onResult)),
+                OnAbort(std::move(onAbort)),
+                OnExit(std::move(onExit)),
+                Workers(workerCount)
+            {
+                if( schedule.size() == taskCount )
+                {
+                    for(const auto& i: schedule)
+                    {
+                        Order.push_back(i.Index);
+                    }
+                }
+                // Writing to pipe of crashed worker must not kill main process.
+                PreviousSigPipe = signal(SIGPIPE, SIG_IGN);
+                for(auto& i: Workers)
+                {
+                    // Worker which can not be started is started again when task is dispatched to it.
+                    std::ignore = Spawn(i);
+                }
+            }
+            CProcessPool(const CProcessPool&) = delete;
+            CProcessPool(CProcessPool&&) = delete;
+            ~CProcessPool()
+            {
+                for(auto& i: Workers)
+                {
+                    Stop(i, false);
+                }
+                signal(SIGPIPE, PreviousSigPipe);
+            }
+
+            CProcessPool& operator=(const CProcessPool&) = delete;
+            CProcessPool& operator=(CProcessPool&&) = delete;
+
+            /// Dispatch tasks and wait for at least one result, returns false when there is nothing left to do.
+            bool Pump()
+            {
+                for(auto& i: Workers)
+                {
+                    Dispatch(i);
+                }
+                std::vector<pollfd> fds{};
+                std::vector<Worker*> busy{};
+                for(auto& i: Workers)
+                {
+                    if( i.Task )
+                    {
+                        fds.push_back({i.ResultFd, POLLIN, 0});
+                        busy.push_back(&i);
+                    }
+                }
+                if( fds.empty() )
+                {
+                    // Tasks are left only when no worker could be started, they are aborted one by one.
+                    return Next < TaskCount;
+                }
+                if( poll(fds.data(), fds.size(), -1) < 0 )
+                {
+                    return true;
+                }
+                for(std::size_t i{0uz}; i < fds.size(); ++i)
+                {
+                    if( fds[i].revents != 0 )
+                    {
+                        Receive(*busy[i]);
+                    }
+                }
+                return true;
+            }
+        private:
+            /// Start worker process, returns reason when it can not be started (eg. process limit), worker is then left stopped.
+            std::optional<std::string> Spawn(Worker& worker)
+            {
+                int command[2]{-1, -1};
+                int result[2]{-1, -1};
+                const auto closePipes = [&]()
+                {
+                    for(const int i: {command[0], command[1], result[0], result[1]})
+                    {
+                        if( i >= 0 )
+                        {
+                            close(i);
+                        }
+                    }
+                };
+                if( pipe(command) != 0 || pipe(result) != 0 )
+                {
+                    const std::string error = std::format("Unable to create pipe of worker process: {}", strerror(errno));
+                    closePipes();
+                    return error;
+                }
+                // Do not let child flush copy of pending parent output or inherit log locked by other thread.
+                GetLog().BeginFork();
+                const pid_t pid = fork();
+                const int error = errno;
+                GetLog().EndFork(pid == 0);
+                if( pid < 0 )
+                {
+                    closePipes();
+                    return std::format("Unable to create worker process: {}", strerror(error));
+                }
+                if( pid == 0 )
+                {
+                    // Ends of other workers pipes must be closed, otherwise crash of other worker is not visible as end of file.
+                    for(const auto& i: Workers)
+                    {
+                        if( &i != &worker && i.Pid > 0 )
+                        {
+                            close(i.CommandFd);
+                            close(i.ResultFd);
+                        }
+                    }
+                    close(command[1]);
+                    close(result[0]);
+                    ResultFd = result[1];
+                    AbortWorker = &AbortCurrentTask;
+                    WorkerLoop(command[0], result[1]);
+                    if( OnExit )
+                    {
+                        OnExit();
+                    }
+                    GetLog().Flush();
+                    _exit(0);
+                }
+                close(command[0]);
+                close(result[1]);
+                worker.Pid = pid;
+                worker.CommandFd = command[1];
+                worker.ResultFd = result[0];
+                worker.Task.reset();
+                return std::nullopt;
+            }
+
+            void WorkerLoop(const int commandFd, const int resultFd)
+            {
+                std::uint64_t task{0u};
+                while( ReadAll(commandFd, &task, sizeof(task)) )
+                {
+                    {
+                        const std::lock_guard lock{ResultMutex};
+                        TaskRunning = true;
+                    }
+                    const std::string payload = Task(static_cast<std::size_t>(task));
+                    // Watchdog thread must not write abort marker in the middle of result.
+                    const std::lock_guard lock{ResultMutex};
+                    TaskRunning = false;
+                    const std::uint64_t size = payload.size();
+                    if( !WriteAll(resultFd, &size, sizeof(size)) || !WriteAll(resultFd, payload.data(), payload.size()) )
+                    {
+                        return;
+                    }
+                }
+            }
+
+            void Dispatch(Worker& worker)
+            {
+                if( worker.Task || Next >= TaskCount )
+                {
+                    return;
+                }
+                if( worker.Pid <= 0 )
+                {
+                    const auto error = Spawn(worker);
+                    if( error )
+                    {
+                        // Other workers keep running tasks, task fails only when none is running.
+                        if( std::ranges::none_of(Workers, [](const Worker& i) { return i.Pid > 0; }) )
+                        {
+                            const std::size_t task = Order.empty() ? Next : Order[Next];
+                            ++Next;
+                            OnAbort(task, *error, 0.0f);
+                        }
+                        return;
+                    }
+                }
+                const std::uint64_t task = Order.empty() ? Next : Order[Next];
+                ++Next;
+                worker.Task = static_cast<std::size_t>(task);
+                worker.Start = PoolClock::now();
+                // Failure is noticed when result is read.
+                std::ignore = WriteAll(worker.CommandFd, &task, sizeof(task));
+            }
+
+            /// Called in worker process by watchdog thread, sends reason instead of result and exits without cleanup as task is still running.
+            /// Task which has already sent its result is not aborted.
+            static void AbortCurrentTask(const std::string& reason)
+            {
+                const std::lock_guard lock{ResultMutex};
+                if( !TaskRunning )
+                {
+                    return;
+                }
+                const std::uint64_t marker = ABORTED_TASK;
+                const std::uint64_t size = reason.size();
+                if( WriteAll(ResultFd, &marker, sizeof(marker)) && WriteAll(ResultFd, &size, sizeof(size)) )
+                {
+                    std::ignore = WriteAll(ResultFd, reason.data(), reason.size());
+                }
+                GetLog().Flush();
+                _exit(EXIT_FAILURE);
+            }
+
+            void Receive(Worker& worker)
+            {
+                std::uint64_t size{0u};
+                std::string payload{};
+                bool received = ReadAll(worker.ResultFd, &size, sizeof(size));
+                const bool aborted = received && size == ABORTED_TASK;
+                if( aborted )
+                {
+                    received = ReadAll(worker.ResultFd, &size, sizeof(size));
+                }
+                if( received )
+                {
+                    payload.resize(static_cast<std::size_t>(size));
+                    received = ReadAll(worker.ResultFd, payload.data(), payload.size());
+                }
+                const std::size_t task = *worker.Task;
+                if( received && !aborted )
+                {
+                    worker.Task.reset();
+                    OnResult(task, payload);
+                    return;
+                }
+                const float duration = std::chrono::duration<float, std::milli>(PoolClock::now() - worker.Start).count();
+                const std::string status = Stop(worker, true);
+                OnAbort(task, aborted && received ? payload : status, duration);
+                // Worker which can not be started again is retried on next dispatch.
+                std::ignore = Spawn(worker);
+            }
+
+            /// Stop worker and wait for it, returns description of how it has finished.
+            std::string Stop(Worker& worker, const bool crashed)
+            {
+                if( worker.Pid <= 0 )
+                {
+                    return {};
+                }
+                close(worker.CommandFd);
+                close(worker.ResultFd);
+                if( crashed )
+                {
+                    // Worker may be still alive if it only closed its pipe.
+                    kill(worker.Pid, SIGKILL);
+                }
+                int status{0};
+                while( waitpid(worker.Pid, &status, 0) < 0 && errno == EINTR ) {}
+                worker = Worker{};
+                return ProcessStatusToString(status);
+            }
+        private:
+            std::size_t TaskCount{0uz};
+            std::size_t Next{0uz};
+            std::vector<std::size_t> Order{};
+            TaskFunction Task{};
+            ResultFunction OnResult{};
+            AbortFunction OnAbort{};
+            ExitFunction OnExit{};
+            std::vector<Worker> Workers{};
+            sighandler_t PreviousSigPipe{};
+            /// Result pipe of worker process, valid only in worker.
+            static inline int ResultFd{-1};
+            /// Guards result pipe of worker process, result and abort marker are written by different threads.
+            static inline std::mutex ResultMutex{};
+            static inline bool TaskRunning{false};
+        };
+    }
+#endif
+
+    /// Static record of registered test, it is constant initialized so registration does not allocate.
+    struct TestDescriptor
+    {
+        /// Adds test cases of this descriptor to manager.
+        using CollectFunction = void(*)(const TestDescriptor&);
+
+        const char* Section{};
+        const char* Name{};
+        std::source_location Location{};
+        CollectFunction Collect{};
+        const TestDescriptor* Next{};
+    };
+
+    /// Static record of source files which test case or whole section depends on.
+    struct DependencyDescriptor
+    {
+        const char* Section{};
+        const char* Name{}; // Null for whole section
+        const char* const* Files{};
+        std::size_t FileCount{0uz};
+        const DependencyDescriptor* Next{};
+    };
+
+    namespace Details
+    {
+        /// Intrusive list of registered descriptors, newest first.
+        constinit inline const TestDescriptor* RegisteredTests{nullptr};
+        /// Intrusive list of registered dependencies, newest first.
+        constinit inline const DependencyDescriptor* RegisteredDependencies{nullptr};
+
+        inline std::string NormalizePath(const std::string_view path)
+        {
+            std::string result{path};
+            std::ranges::replace(result, '\\', '/');
+            while( result.starts_with("./") )
+            {
+                result.erase(0uz, 2uz);
+            }
+            return result;
+        }
+
+        /// True when both paths name the same file, shorter one must be whole trailing components of longer one,
+        /// eg. 'Source/Math.cpp' and '/home/user/Project/Source/Math.cpp'.
+        inline bool IsSamePath(const std::string_view first, const std::string_view second)
+        {
+            std::string longer = NormalizePath(first);
+            std::string shorter = NormalizePath(second);
+            if( longer.size() < shorter.size() )
+            {
+                std::swap(longer, shorter);
+            }
+            if( shorter.empty() || !longer.ends_with(shorter) )
+            {
+                return false;
+            }
+            return longer.size() == shorter.size() || longer[longer.size() - shorter.size() - 1uz] == '/';
+        }
+    }
+
+    /// Options of test run, read from command line.
+    struct RunOptions
+    {
+        std::string Filter{};
+        std::size_t Jobs{1uz};
+        bool Isolate{false};
+        std::size_t ShardIndex{0uz};
+        std::size_t ShardCount{1uz};
+        std::string ShardTimings{};
+        std::string CacheDir{}; // Empty when cache is disabled, it is enabled by --cache-dir
+        bool RerunFailed{false};
+        bool FailedFirst{false};
+        std::optional<std::vector<std::string>> ChangedFiles{}; // Select only test cases affected by these files
+        bool DryRun{false};
+        bool PerfCounters{false};
+        std::chrono::milliseconds Timeout{0}; // Zero means no limit
+        std::size_t Repeat{0uz}; // Zero means once, or without limit with UntilFail
+        bool UntilFail{false};
+        bool Shuffle{false};
+        std::uint64_t ShuffleSeed{0u};
+    };
+
+    /// Manages tests and runs them
+    class CTestManager final
+    {
+        /// Tests selected to run, grouped by section.
+        using TestPlan = std::vector<std::pair<std::string, std::vector<CTestCase*>>>;
+    private:
+        CTestManager() = default;
+    public:
+        CTestManager(const CTestManager&) = delete;
+        CTestManager(CTestManager&&) = delete;
+        ~CTestManager() = default;
+
+        CTestManager& operator=(const CTestManager&) = delete;
+        CTestManager& operator=(CTestManager&&) = delete;
+
+        static CTestManager& Instance()
+        {
+            static CTestManager manager;
+            return manager;
+        }
+
+        CTestCase* GetActiveTest() const { return Details::ActiveTest; }
+        const BenchmarkOptions& GetBenchmarkOptions() const { return Benchmark; }
+        /// Seed of schedule replayed by MTEST_EXPLORE in given test case, given by --explore-seed=Section.Test:Seed.
+        std::optional<std::uint64_t> GetExploreSeed(const std::string& fullname) const
+        {
+            const auto found = ExploreSeeds.find(fullname);
+            return found != ExploreSeeds.end() ? std::optional<std::uint64_t>{found->second} : std::nullopt;
+        }
+
+        /// Add test case, returns null when test case with same name already exists.
+        CTestCase* AddTest(const std::string& section, const std::string& name, const std::source_location location, FixtureFactory factory)
+        {
+            if( !TestNames[section].insert(name).second )
+            {
+                GetLog().Write(EConsoleColor::Red, "[Error  ] {} already exists\n", CTestCase::MakeFullname(section, name));
+                return nullptr;
+            }
+            return GetSectionTests(section).emplace_back(std::make_unique<CTestCase>(section, name, location, std::move(factory))).get();
+        }
+
+        /// Reserve space for test cases that will be added to section.
+        void ReserveTests(const std::string& section, const std::size_t count)
+        {
+            auto& tests = GetSectionTests(section);
+            tests.reserve(tests.size() + count);
+            auto& names = TestNames[section];
+            names.reserve(names.size() + count);
+        }
+
+        bool Run(int argc, const char* const argv[])
+        {
+            std::vector<std::string> cmd{};
+            for(int i{1}; i < argc; ++i)
+            {
+                cmd.push_back(argv[i]);
+            }
+            return Run(cmd);
+        }
+
+        bool Run(const std::vector<std::string>& cmd)
+        {
+            RunOptions options{};
+            if( !ParseOptions(cmd, options) )
+            {
+                return false;
+            }
+            CollectTests();
+            for(const auto& [fullname, seed]: ExploreSeeds)
+            {
+                const bool found = std::ranges::any_of(Tests, [&](const auto& section)
+                {
+                    return std::ranges::any_of(section.second, [&](const auto& test) { return test->GetFullname() == fullname; });
+                });
+                if( !found )
+                {
+                    GetLog().Write(EConsoleColor::Yellow, "[Manager] Test case '{}' given by --explore-seed is not registered\n", fullname);
+                }
+            }
+            if( !options.CacheDir.empty() )
+            {
+                Timings = Details::LoadTimings(GetCachePath(options, "timings.txt")).value_or(Timings);
+                Results = Details::LoadResults(GetCachePath(options, "results.txt")).value_or(Results);
+            }
+            TestPlan basePlan = MakePlan(options);
+            if( options.ChangedFiles )
+            {
+                SelectChanged(basePlan, *options.ChangedFiles);
+            }
+            if( options.RerunFailed )
+            {
+                SelectFailed(basePlan);
+            }
+            const auto [totalTestsCount, filteredTestsCount] = GetTestCount(basePlan, options.Filter);
+            if(filteredTestsCount != totalTestsCount)
+            {
+                GetLog().Write(EConsoleColor::Blue, "[Manager] Running {} from {} tests\n", filteredTestsCount, totalTestsCount);
+            }
+            else
+            {
+                GetLog().Write(EConsoleColor::Blue, "[Manager] Running {} tests\n", totalTestsCount);
+            }
+            if( !options.Filter.empty() )
+            {
+                GetLog().Write(EConsoleColor::Blue, "[Manager] Test filter: '{}'\n", options.Filter);
+            }
+            if( options.ShardCount > 1uz )
+            {
+                GetLog().Write(EConsoleColor::Blue, "[Manager] Test shard: {} of {}\n", options.ShardIndex, options.ShardCount);
+            }
+            if( options.DryRun )
+            {
+                PrintPlan(basePlan, options.Filter);
+                GetLog().Flush();
+                Tests.clear();
+                Sections.clear();
+                return true;
+            }
+            if( options.PerfCounters )
+            {
+                EnablePerfCounters();
+            }
+            if( Details::TrackAllocations && !Details::AllocationTrackerInstalled )
+            {
+                GetLog().Write(EConsoleColor::Red, "[Manager] MTEST_CONFIG_TRACK_ALLOCATIONS is defined but allocation functions are not replaced, "
+                    "use MTEST_ALLOCATION_TRACKER at global scope with own main()\n");
+            }
+            if( options.Timeout > std::chrono::milliseconds{0} )
+            {
+                GetLog().Write(EConsoleColor::Blue, "[Manager] Test timeout: {} ms\n", options.Timeout.count());
+            }
+            Details::DefaultTimeout = options.Timeout;
+            if( options.Shuffle )
+            {
+                GetLog().Write(EConsoleColor::Blue, "[Manager] Shuffle seed: {}\n", options.ShuffleSeed);
+            }
+            const std::size_t iterations = options.Repeat > 0uz ? options.Repeat :
+                options.UntilFail ? std::numeric_limits<std::size_t>::max() : 1uz;
+            const bool repeated = iterations > 1uz;
+            GetLog().Notify([](ISink& sink) { sink.OnRunStart(); });
+            RunSummary total{};
+            // Result of test case in this run, failure in any iteration wins.
+            std::unordered_map<std::string, ETestResult> runResults{};
+            std::size_t failedIterations{0uz};
+            std::size_t runIterations{0uz};
+            for(std::size_t iteration{0uz}; iteration < iterations; ++iteration)
+            {
+                TestPlan plan = basePlan;
+                if( iteration > 0uz )
+                {
+                    ResetTests(plan);
+                }
+                if( options.Shuffle )
+                {
+                    // Each iteration has its own seed, so single iteration can be replayed with --shuffle=seed.
+                    const std::uint64_t seed = iteration == 0uz ? options.ShuffleSeed : Details::CRandom{options.ShuffleSeed + iteration}.Next();
+                    ShufflePlan(plan, seed);
+                    if( repeated )
+                    {
+                        GetLog().Write(EConsoleColor::Blue, "[Manager] Iteration {} shuffle seed: {}\n", iteration + 1uz, seed);
+                    }
+                }
+                if( options.FailedFirst )
+                {
+                    PrioritizeFailed(plan);
+                }
+                if( repeated )
+                {
+                    GetLog().Write(EConsoleColor::Blue, "[Manager] Iteration {}\n", iteration + 1uz);
+                }
+                RunSummary summary{};
+                const bool passed = RunPlan(plan, options, summary);
+                UpdateTimings(plan);
+                UpdateResults(plan, runResults);
+                ++runIterations;
+                total.Successful += summary.Successful;
+                total.Failed += summary.Failed;
+                total.Skipped += summary.Skipped;
+                total.Duration += summary.Duration;
+                if( !passed )
+                {
+                    ++failedIterations;
+                    if( options.UntilFail )
+                    {
+                        GetLog().Write(EConsoleColor::Red, "[Manager] Failed in iteration {}\n", iteration + 1uz);
+                        break;
+                    }
+                }
+            }
+            GetLog().Notify([&](ISink& sink) { sink.OnRunEnd(total); });
+            if( repeated )
+            {
+                GetLog().Write(failedIterations > 0uz ? EConsoleColor::Red : EConsoleColor::Green, "[Manager] {} of {} iterations failed\n",
+                    failedIterations, runIterations);
+            }
+            if( !options.CacheDir.empty() )
+            {
+                for(auto& [key, result]: runResults)
+                {
+                    Results[key] = result;
+                }
+                if( !Details::SaveTimings(GetCachePath(options, "timings.txt"), Timings) ||
+                    !Details::SaveResults(GetCachePath(options, "results.txt"), Results) )
+                {
+                    GetLog().Write(EConsoleColor::Yellow, "[Manager] Unable to write cache directory '{}'\n", options.CacheDir);
+                }
+            }
+            GetLog().Flush();
+            Tests.clear();
+            Sections.clear();
+            // Return
+            return failedIterations == 0uz;
+        }
+
+        /// Run tests of plan once and print summary.
+        bool RunPlan(const TestPlan& plan, const RunOptions& options, RunSummary& summary)
+        {
+            // Tests are run on worker threads in parallel, but their output is written in the same order as in serial run.
+            std::vector<CTestCase*> queue{};
+            for(const auto& i: plan)
+            {
+                queue.insert(queue.end(), i.second.begin(), i.second.end());
+            }
+            const std::size_t workers = std::min(options.Jobs, queue.size());
+            const bool isolate = options.Isolate && !queue.empty();
+            if( isolate )
+            {
+                GetLog().Write(EConsoleColor::Blue, "[Manager] Using {} isolated worker processes\n", std::max(workers, 1uz));
+            }
+            else if( workers > 1uz )
+            {
+                GetLog().Write(EConsoleColor::Blue, "[Manager] Using {} worker threads\n", workers);
+            }
+            GetLog().Write("\n");
+            // Longest tests are started first, so they do not finish last on one worker.
+            std::vector<Details::ScheduledTask> schedule{};
+            if( isolate || workers > 1uz )
+            {
+                std::vector<std::optional<float>> durations{};
+                for(const auto* i: queue)
+                {
+                    const auto it = Timings.find(i->GetFullname());
+                    durations.push_back(it != Timings.end() ? std::optional{it->second} : std::nullopt);
+                }
+                schedule = Details::ScheduleLongestFirst(durations);
+                if( options.FailedFirst )
+                {
+                    if( schedule.empty() )
+                    {
+                        for(std::size_t i{0uz}; i < queue.size(); ++i)
+                        {
+                            schedule.push_back({i, 1.0f});
+                        }
+                    }
+                    // Previous failures are started before anything else, so they are reported as soon as possible.
+                    std::ranges::stable_partition(schedule, [&](const Details::ScheduledTask& i) { return IsKnownFailed(*queue[i.Index]); });
+                }
+            }
+            std::unique_ptr<Details::CWorkStealingPool> pool{};
+        #ifdef MTEST_LINUX_PLATFORM
+            std::unique_ptr<Details::CProcessPool> processPool{};
+            if( isolate )
+            {
+                processPool = std::make_unique<Details::CProcessPool>(std::max(workers, 1uz), queue.size(),
+                    [&](std::size_t task)
+                    {
+                        // Called in worker process.
+                        auto& testCase = *queue[task];
+                        RunTest(testCase, options.Filter, true);
+                        std::string result = testCase.SaveResult();
+                        LogBuffer{}.swap(testCase.GetOutput());
+                        return result;
+                    },
+                    [&](std::size_t task, std::string_view result)
+                    {
+                        queue[task]->LoadResult(result);
+                        queue[task]->MarkFinished();
+                    },
+                    [&](std::size_t task, const std::string& reason, float duration)
+                    {
+                        auto& testCase = *queue[task];
+                        LogBuffer* previous = GetLog().SetCapture(&testCase.GetOutput());
+                        testCase.Abort(reason, duration);
+                        GetLog().SetCapture(previous);
+                        testCase.MarkFinished();
+                    },
+                    []()
+                    {
+                        Details::ReleaseSharedFixtures(nullptr);
+                    },
+                    schedule);
+            }
+            else
+        #endif
+            if( workers > 1uz )
+            {
+                pool = std::make_unique<Details::CWorkStealingPool>(workers, queue.size(), [&](std::size_t, std::size_t task)
+                {
+                    if( !queue[task]->IsAsync() )
+                    {
+                        RunTest(*queue[task], options.Filter, true);
+                    }
+                },
+                []()
+                {
+                    Details::ReleaseSharedFixtures(nullptr);
+                },
+                schedule);
+            }
+            const bool buffered = isolate || pool;
+            // Async tests wait together on one event loop, isolated worker runs them one by one.
+            std::vector<CTestCase*> asyncTests{};
+            std::thread asyncThread{};
+            if( !isolate )
+            {
+                std::ranges::copy_if(queue, std::back_inserter(asyncTests), &CTestCase::IsAsync);
+            }
+            if( !asyncTests.empty() && pool )
+            {
+                asyncThread = std::thread([&]()
+                {
+                    RunAsyncTests(asyncTests, options.Filter);
+                    Details::ReleaseSharedFixtures(nullptr);
+                });
+            }
+            else
+            {
+                RunAsyncTests(asyncTests, options.Filter);
+            }
+            // Run tests now.
+            float totalTime{0.0f};
+            std::vector<CTestCase*> failedTests{};
+            std::vector<CTestCase*> skippedTests{};
+            std::vector<CTestCase*> successfulTests{};
+            for(const auto& i: plan)
+            {
+                float sectionTime{0.0f};
+                GetLog().Write(EConsoleColor::Blue, "[-------] Running section {} which has {} tests\n", i.first, i.second.size());
+                GetLog().Notify([&](ISink& sink) { sink.OnSectionStart(i.first); });
+                for(auto* testCase: i.second)
+                {
+                #ifdef MTEST_LINUX_PLATFORM
+                    while( processPool && !testCase->IsFinished() && processPool->Pump() ) {}
+                #endif
+                    if( buffered || testCase->IsAsync() )
+                    {
+                        testCase->WaitFinished();
+                        GetLog().Write(std::move(testCase->GetOutput()));
+                        LogBuffer{}.swap(testCase->GetOutput());
+                    }
+                    else
+                    {
+                        RunTest(*testCase, options.Filter, false);
+                    }
+                    ReportTest(*testCase);
+                    // Update result.
+                    sectionTime += testCase->GetDuration();
+                    if( testCase->IsFailed() )
+                    {
+                        failedTests.push_back(testCase);
+                    }
+                    else if( testCase->IsSkipped() )
+                    {
+                        skippedTests.push_back(testCase);
+                    }
+                    else
+                    {
+                        successfulTests.push_back(testCase);
+                    }
+                }
+                if( !buffered )
+                {
+                    Details::ReleaseSharedFixtures(&i.first);
+                }
+                GetLog().Notify([&](ISink& sink) { sink.OnSectionEnd(i.first); });
+                GetLog().Write(EConsoleColor::Blue, "[-------] Section {} finished {}\n\n", i.first, Details::FormatTime(sectionTime));
+                totalTime += sectionTime;
+            }
+            if( asyncThread.joinable() )
+            {
+                asyncThread.join();
+            }
+            Details::ReleaseSharedFixtures(nullptr);
+            pool.reset();
+        #ifdef MTEST_LINUX_PLATFORM
+            processPool.reset();
+        #endif
+            // Print result
+            GetLog().Write(EConsoleColor::Blue, "[Manager] Running finished {}\n", Details::FormatTime(totalTime));
+            if( !queue.empty() )
+            {
+                // Print failed tests for quick lookup.
+                if( !failedTests.empty() )
+                {
+                    GetLog().Write(EConsoleColor::Red, "[Manager] Failed test list:\n");
+                    for(const auto* i: failedTests)
+                    {
+                        i->PrintResult(false);
+                    }
+                }
+                GetLog().Write(EConsoleColor::Blue, "[Manager] Test summary:\n");
+                PrintSummary(EConsoleColor::Green, "Successful", successfulTests);
+                PrintSummary(EConsoleColor::Red, "Failed", failedTests);
+                PrintSummary(EConsoleColor::Magenta, "Skipped", skippedTests);
+            }
+            else
+            {
+                GetLog().Write(EConsoleColor::Blue, "[Manager] No tests are present\n");
+            }
+            summary = RunSummary{successfulTests.size(), failedTests.size(), skippedTests.size(), totalTime};
+            return failedTests.empty();
+        }
+    private:
+        bool ParseOptions(const std::vector<std::string>& cmd, RunOptions& options)
+        {
+            for(const auto& i: cmd)
+            {
+                if( i.starts_with("-F=") || i.starts_with("--Filter=") )
+                {
+                    options.Filter = Details::OptionValue(i);
+                }
+                else if( i.starts_with("-J=") || i.starts_with("--jobs=") )
+                {
+                    if( !ParseNumberOption(i, options.Jobs, 0uz) )
+                    {
+                        return false;
+                    }
+                    // Zero means use all hardware threads.
+                    if( options.Jobs == 0uz )
+                    {
+                        options.Jobs = std::max(std::thread::hardware_concurrency(), 1u);
+                    }
+                }
+                else if( i == "--isolate" )
+                {
+                #ifdef MTEST_LINUX_PLATFORM
+                    options.Isolate = true;
+                #else
+                    GetLog().Write(EConsoleColor::Red, "[Manager] Process isolation is not supported on this platform\n");
+                    return false;
+                #endif
+                }
+                else if( i.starts_with("--repeat=") )
+                {
+                    if( !ParseNumberOption(i, options.Repeat, 1uz) )
+                    {
+                        return false;
+                    }
+                }
+                else if( i == "--until-fail" )
+                {
+                    options.UntilFail = true;
+                }
+                else if( i == "--shuffle" )
+                {
+                    std::random_device device{};
+                    options.Shuffle = true;
+                    options.ShuffleSeed = (static_cast<std::uint64_t>(device()) << 32u) | device();
+                }
+                else if( i.starts_with("--shuffle=") )
+                {
+                    std::size_t seed{0uz};
+                    if( !ParseNumberOption(i, seed, 0uz) )
+                    {
+                        return false;
+                    }
+                    options.Shuffle = true;
+                    options.ShuffleSeed = seed;
+                }
+                else if( i.starts_with("--timeout=") )
+                {
+                    std::size_t value{0uz};
+                    if( !ParseNumberOption(i, value, 0uz) )
+                    {
+                        return false;
+                    }
+                    options.Timeout = std::chrono::milliseconds{value};
+                }
+                else if( i == "--perf-counters" )
+                {
+                    options.PerfCounters = true;
+                }
+                else if( i == "--async-log" )
+                {
+                    GetLog().EnableAsync();
+                }
+                else if( i.starts_with("--junit-out=") )
+                {
+                    if( !CreateReportSink<CJUnitSink>(Details::OptionValue(i)) )
+                    {
+                        return false;
+                    }
+                }
+                else if( i.starts_with("--json-out=") )
+                {
+                    if( !CreateReportSink<CJsonLinesSink>(Details::OptionValue(i)) )
+                    {
+                        return false;
+                    }
+                }
+                else if( i.starts_with("--trace-out=") )
+                {
+                    if( !CreateReportSink<CTraceSink>(Details::OptionValue(i)) )
+                    {
+                        return false;
+                    }
+                    Details::CollectTrace = true;
+                }
+                else if( i.starts_with("--shard-index=") )
+                {
+                    if( !ParseNumberOption(i, options.ShardIndex, 0uz) )
+                    {
+                        return false;
+                    }
+                }
+                else if( i.starts_with("--shard-count=") )
+                {
+                    if( !ParseNumberOption(i, options.ShardCount, 1uz) )
+                    {
+                        return false;
+                    }
+                }
+                else if( i.starts_with("--shard-timings=") )
+                {
+                    options.ShardTimings = Details::OptionValue(i);
+                }
+                else if( i.starts_with("--cache-dir=") )
+                {
+                    options.CacheDir = Details::OptionValue(i);
+                }
+                else if( i == "--no-cache" )
+                {
+                    options.CacheDir.clear();
+                }
+                else if( i.starts_with("--changed-files=") )
+                {
+                    if( !ParseChangedFiles(Details::OptionValue(i), options) )
+                    {
+                        return false;
+                    }
+                }
+                else if( i == "--dry-run" )
+                {
+                    options.DryRun = true;
+                }
+                else if( i == "--rerun-failed" )
+                {
+                    options.RerunFailed = true;
+                }
+                else if( i == "--failed-first" )
+                {
+                    options.FailedFirst = true;
+                }
+                else if( i.starts_with("--benchmark-time=") )
+                {
+                    std::size_t value{0uz};
+                    if( !ParseNumberOption(i, value, 1uz) )
+                    {
+                        return false;
+                    }
+                    Benchmark.MinTime = std::chrono::milliseconds{value};
+                }
+                else if( i.starts_with("--benchmark-samples=") )
+                {
+                    if( !ParseNumberOption(i, Benchmark.Samples, 1uz) )
+                    {
+                        return false;
+                    }
+                }
+                else if( i.starts_with("--explore-seed=") )
+                {
+                    const std::string value = Details::OptionValue(i);
+                    const auto separator = value.rfind(':');
+                    const auto seed = separator != std::string::npos ? Details::ParseNumber(value.substr(separator + 1uz)) : std::nullopt;
+                    if( separator == 0uz || !seed )
+                    {
+                        GetLog().Write(EConsoleColor::Red, "[Manager] Invalid argument: {}\n", i);
+                        return false;
+                    }
+                    ExploreSeeds[value.substr(0uz, separator)] = *seed;
+                }
+                else
+                {
+                    GetLog().Write(EConsoleColor::Red, "[Manager] Invalid argument: {}\n", i);
+                    return false;
+                }
+            }
+            if( options.ShardIndex >= options.ShardCount )
+            {
+                GetLog().Write(EConsoleColor::Red, "[Manager] Shard index {} must be lower than shard count {}\n", options.ShardIndex, options.ShardCount);
+                return false;
+            }
+            if( (options.RerunFailed || options.FailedFirst) && options.CacheDir.empty() )
+            {
+                GetLog().Write(EConsoleColor::Red, "[Manager] --rerun-failed and --failed-first need results of previous run, enable cache with --cache-dir=Directory\n");
+                return false;
+            }
+            return true;
+        }
+
+        /// Tests of section, new section is added after already known ones.
+        std::vector<std::unique_ptr<CTestCase>>& GetSectionTests(const std::string& section)
+        {
+            const auto [it, inserted] = Tests.try_emplace(section);
+            if( inserted )
+            {
+                Sections.push_back(section);
+            }
+            return it->second;
+        }
+
+        /// Turn on performance counters, report if they are not available.
+        void EnablePerfCounters()
+        {
+            const auto& counters = Details::GetPerfCounters();
+            if( !counters.IsAvailable() )
+            {
+                GetLog().Write(EConsoleColor::Yellow, "[Manager] Performance counters are not available on this system\n");
+                return;
+            }
+            if( !counters.IsHardwareAvailable() )
+            {
+                GetLog().Write(EConsoleColor::Yellow, "[Manager] Hardware performance counters are not available (check perf_event_paranoid), using software counters\n");
+            }
+            Details::CollectPerfCounters = true;
+        }
+
+        /// Add tests from static descriptors, it is done once on first run in registration order.
+        void CollectTests()
+        {
+            if( Collected )
+            {
+                return;
+            }
+            Collected = true;
+            std::vector<const TestDescriptor*> descriptors{};
+            for(const auto* i = Details::RegisteredTests; i; i = i->Next)
+            {
+                descriptors.push_back(i);
+            }
+            for(auto i = descriptors.rbegin(); i != descriptors.rend(); ++i)
+            {
+                (*i)->Collect(**i);
+            }
+            // Misspelled dependency would silently drop test case from selection by changed files.
+            for(const auto* i = Details::RegisteredDependencies; i; i = i->Next)
+            {
+                const auto section = Tests.find(i->Section);
+                const bool found = section != Tests.end() && std::ranges::any_of(section->second, [&](const auto& test)
+                {
+                    return IsDependencyOf(*i, *test);
+                });
+                if( !found )
+                {
+                    GetLog().Write(EConsoleColor::Yellow, "[Manager] Dependency of {} in MTEST_{}DEPENDS_ON matches no test case\n",
+                        i->Name ? std::format("{}.{}", i->Section, i->Name) : i->Section, i->Name ? "" : "SECTION_");
+                }
+            }
+        }
+
+        /// Report sink which can not open its file fails the run, otherwise it would end successfully without report.
+        template<class T>
+        bool CreateReportSink(const std::string& path)
+        {
+            auto sink = std::make_unique<T>(path);
+            if( !sink->IsOpen() )
+            {
+                GetLog().Write(EConsoleColor::Red, "[Manager] Unable to open report file '{}'\n", path);
+                return false;
+            }
+            GetLog().AddSink(std::move(sink));
+            return true;
+        }
+
+        bool ParseNumberOption(const std::string& option, std::size_t& value, const std::size_t minimum)
+        {
+            const auto number = Details::ParseNumber(Details::OptionValue(option));
+            if( !number || *number < minimum )
+            {
+                GetLog().Write(EConsoleColor::Red, "[Manager] Invalid argument: {}\n", option);
+                return false;
+            }
+            value = *number;
+            return true;
+        }
+
+        /// Select tests of this shard. Tests are assigned to shards by hash of their full name, if timings are given
+        /// tests are packed longest first to the least loaded shard, unknown tests first. Result is same on every machine.
+        TestPlan MakePlan(const RunOptions& options) const
+        {
+            std::unordered_map<const CTestCase*, std::size_t> balanced{};
+            if( options.ShardCount > 1uz && !options.ShardTimings.empty() )
+            {
+                const auto timings = Details::LoadTimings(options.ShardTimings);
+                if( !timings )
+                {
+                    GetLog().Write(EConsoleColor::Yellow, "[Manager] Unable to read timings file '{}', shards are not balanced\n", options.ShardTimings);
+                }
+                else
+                {
+                    std::vector<const CTestCase*> tests{};
+                    for(const auto& i: Tests)
+                    {
+                        for(const auto& j: i.second)
+                        {
+                            tests.push_back(j.get());
+                        }
+                    }
+                    // Ties are ordered by name, so every shard makes same assignment.
+                    std::ranges::sort(tests, {}, &CTestCase::GetFullname);
+                    std::vector<std::optional<float>> durations{};
+                    for(const auto* i: tests)
+                    {
+                        const auto it = timings->find(i->GetFullname());
+                        durations.push_back(it != timings->end() ? std::optional{it->second} : std::nullopt);
+                    }
+                    const auto schedule = Details::ScheduleLongestFirst(durations);
+                    const auto shards = Details::PackLongestFirst(schedule, options.ShardCount);
+                    for(std::size_t i{0uz}; i < schedule.size(); ++i)
+                    {
+                        balanced[tests[schedule[i].Index]] = shards[i];
+                    }
+                }
+            }
+            TestPlan plan{};
+            for(const auto& section: Sections)
+            {
+                const auto& tests = Tests.at(section);
+                std::vector<CTestCase*> selected{};
+                for(const auto& j: tests)
+                {
+                    const auto it = balanced.find(j.get());
+                    const std::size_t shard = it != balanced.end() ? it->second : Details::Hash(j->GetFullname()) % options.ShardCount;
+                    if( shard == options.ShardIndex )
+                    {
+                        selected.push_back(j.get());
+                    }
+                }
+                if( !selected.empty() )
+                {
+                    plan.emplace_back(section, std::move(selected));
+                }
+            }
+            return plan;
+        }
+
+        /// List of changed files is separated by commas, or it is read from file given after '@', one path per line.
+        bool ParseChangedFiles(const std::string& value, RunOptions& options)
+        {
+            std::vector<std::string> files{};
+            if( value.starts_with('@') )
+            {
+                const auto lines = Details::ReadLines(value.substr(1uz));
+                if( !lines )
+                {
+                    GetLog().Write(EConsoleColor::Red, "[Manager] Unable to read changed files from '{}'\n", value.substr(1uz));
+                    return false;
+                }
+                files = *lines;
+            }
+            else
+            {
+                for(const auto i: std::views::split(value, ','))
+                {
+                    files.emplace_back(std::string_view{i});
+                }
+            }
+            options.ChangedFiles.emplace();
+            for(const auto& i: files)
+            {
+                const auto begin = i.find_first_not_of(" \t\r");
+                if( begin != std::string::npos )
+                {
+                    options.ChangedFiles->push_back(i.substr(begin, i.find_last_not_of(" \t\r") - begin + 1uz));
+                }
+            }
+            return true;
+        }
+
+        /// Dependency of test case applies also to all rows of table test case.
+        static bool IsDependencyOf(const DependencyDescriptor& dependency, const CTestCase& testCase)
+        {
+            if( dependency.Section != testCase.GetSection() )
+            {
+                return false;
+            }
+            if( !dependency.Name )
+            {
+                return true;
+            }
+            const std::string_view name{testCase.GetName()};
+            return name == dependency.Name || (name.starts_with(dependency.Name) && name.substr(std::strlen(dependency.Name)).starts_with('['));
+        }
+
+        /// Test case is affected when it is defined in one of changed files or it depends on one of them.
+        bool IsAffected(const CTestCase& testCase, const std::vector<std::string>& changedFiles) const
+        {
+            const auto isChanged = [&](const std::string_view path)
+            {
+                return std::ranges::any_of(changedFiles, [&](const std::string& i) { return Details::IsSamePath(path, i); });
+            };
+            if( isChanged(testCase.GetPath()) )
+            {
+                return true;
+            }
+            for(const auto* i = Details::RegisteredDependencies; i; i = i->Next)
+            {
+                if( !IsDependencyOf(*i, testCase) )
+                {
+                    continue;
+                }
+                if( std::ranges::any_of(std::span{i->Files, i->FileCount}, isChanged) )
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /// Keep only test cases affected by changed files.
+        void SelectChanged(TestPlan& plan, const std::vector<std::string>& changedFiles) const
+        {
+            TestPlan affected{};
+            for(const auto& [section, tests]: plan)
+            {
+                std::vector<CTestCase*> selected{};
+                std::ranges::copy_if(tests, std::back_inserter(selected), [&](const CTestCase* i) { return IsAffected(*i, changedFiles); });
+                if( !selected.empty() )
+                {
+                    affected.emplace_back(section, std::move(selected));
+                }
+            }
+            plan = std::move(affected);
+            GetLog().Write(EConsoleColor::Blue, "[Manager] Selected tests affected by {} changed files\n", changedFiles.size());
+        }
+
+        /// Print test cases which would be run.
+        void PrintPlan(const TestPlan& plan, const std::string& filter) const
+        {
+            std::size_t count{0uz};
+            for(const auto& i: plan)
+            {
+                for(const auto* j: i.second)
+                {
+                    if( j->IsRun(filter) )
+                    {
+                        GetLog().Write("[Dry run] {} in File: {}, Line: {}\n", j->GetFullname(), j->GetFile(), j->GetLine());
+                        ++count;
+                    }
+                }
+            }
+            GetLog().Write(EConsoleColor::Blue, "[Manager] Dry run, {} tests would be run\n", count);
+        }
+
+        std::string GetCachePath(const RunOptions& options, const std::string& name) const
+        {
+            return (std::filesystem::path{options.CacheDir} / name).string();
+        }
+
+        /// Test case is identified in result cache by its full name and location, so test moved to another place is new test.
+        static std::string GetResultKey(const CTestCase& testCase)
+        {
+            return std::format("{} {} {}", testCase.GetFullname(), testCase.GetLine(), testCase.GetFile());
+        }
+
+        bool IsKnownFailed(const CTestCase& testCase) const
+        {
+            const auto it = Results.find(GetResultKey(testCase));
+            return it != Results.end() && it->second == ETestResult::Fail;
+        }
+
+        /// Keep only test cases which failed in previous run, all are kept when no failure is known.
+        void SelectFailed(TestPlan& plan) const
+        {
+            TestPlan failed{};
+            for(const auto& [section, tests]: plan)
+            {
+                std::vector<CTestCase*> selected{};
+                std::ranges::copy_if(tests, std::back_inserter(selected), [&](const CTestCase* i) { return IsKnownFailed(*i); });
+                if( !selected.empty() )
+                {
+                    failed.emplace_back(section, std::move(selected));
+                }
+            }
+            if( failed.empty() )
+            {
+                GetLog().Write(EConsoleColor::Yellow, "[Manager] No failed tests are known from previous run, running all tests\n");
+                return;
+            }
+            plan = std::move(failed);
+        }
+
+        /// Move test cases which failed in previous run to front, sections which contain them go first.
+        void PrioritizeFailed(TestPlan& plan) const
+        {
+            for(auto& i: plan)
+            {
+                std::ranges::stable_partition(i.second, [&](const CTestCase* j) { return IsKnownFailed(*j); });
+            }
+            std::ranges::stable_partition(plan, [&](const auto& i) { return !i.second.empty() && IsKnownFailed(*i.second.front()); });
+        }
+
+        /// Passed or failed result of test cases which were run, failure in any iteration is kept.
+        void UpdateResults(const TestPlan& plan, std::unordered_map<std::string, ETestResult>& results) const
+        {
+            for(const auto& i: plan)
+            {
+                for(const auto* j: i.second)
+                {
+                    if( j->IsSkipped() )
+                    {
+                        continue;
+                    }
+                    auto& result = results.try_emplace(GetResultKey(*j), ETestResult::Success).first->second;
+                    if( j->IsFailed() )
+                    {
+                        result = ETestResult::Fail;
+                    }
+                }
             }
-            return true;
         }
 
-        void Run(const std::string& filter)
+        /// Remember durations of test cases which were run, they are used to schedule next run.
+        void UpdateTimings(const TestPlan& plan)
         {
-            const TestClockStamp Start = TestClock::now();
-            GetLog().Write(EConsoleColor::Blue, "[Start  ] {}\n", GetFullname());
-            // Run
-            bool needCleanup{false};
-            Runner([&]()
+            for(const auto& i: plan)
             {
-                if( !IsRun(filter) )
+                for(const auto* j: i.second)
                 {
-                    Skip("Test case is skipped by Command-line");
+                    if( !j->IsSkipped() )
+                    {
+                        Timings[j->GetFullname()] = j->GetDuration();
+                    }
                 }
-                if( Fixture->MTest_Skip() )
+            }
+        }
+
+        void ResetTests(const TestPlan& plan)
+        {
+            for(const auto& i: plan)
+            {
+                for(auto* j: i.second)
                 {
-                    Skip("Test case is skipped by Fixture");
+                    j->Reset();
                 }
-                // Setup test case
-                needCleanup = true;
-                Fixture->MTest_Setup();
-                //
-                Fixture->MTest_Run();
-            });
-            // Clear if needed
-            if( needCleanup )
+            }
+        }
+
+        /// Shuffle order of sections and order of test cases in each section.
+        void ShufflePlan(TestPlan& plan, const std::uint64_t seed) const
+        {
+            Details::CRandom random{seed};
+            random.Shuffle(plan);
+            for(auto& i: plan)
             {
-                Runner([&]()
-                {
-                    Fixture->MTest_Cleanup();
-                });
+                random.Shuffle(i.second);
             }
-            //
-            Duration = TestClockDuration(TestClock::now()-Start).count();
-            PrintResult(true);
         }
 
-        template<IsEnumeration T>
-        bool CheckEqual(const T& value, const T& wanted, const std::string& message, const EFailType type,
-            const std::source_location location = std::source_location::current())
+        /// Pass result of finished test case to structured sinks.
+        void ReportTest(const CTestCase& testCase)
         {
-            return CheckEqual(std::to_underlying(value), std::to_underlying(wanted), message, type, location);
+            GetLog().Notify([&](ISink& sink)
+            {
+                sink.OnTestReport(testCase);
+                for(const auto& i: testCase.GetFailures())
+                {
+                    sink.OnTestFailure(testCase, i);
+                }
+                sink.OnTestEnd(testCase);
+            });
         }
 
-        template<class T, class U>
-        bool CheckEqual(const T& value, const U& wanted, const std::string& message, const EFailType type,
-            const std::source_location location = std::source_location::current())
+        /// Run async test cases together on one event loop on calling thread, their output is kept in test cases until reported.
+        void RunAsyncTests(const std::vector<CTestCase*>& tests, const std::string& filter)
         {
-            if( value == wanted )
+            if( tests.empty() )
             {
-                return true;
+                return;
             }
-            HandleFailure(std::format("Value '{}' is '{}' but should be '{}'", message, value, wanted), type, location);
-            return false;
+            Details::CEventLoop loop{true};
+            for(auto* i: tests)
+            {
+                loop.Spawn(i->RunConcurrent(filter), i);
+            }
+            loop.Run();
         }
 
-        template<IsEnumeration T>
-        bool CheckNotEqual(const T& value, const T& wanted, const std::string& message, const EFailType type,
-            const std::source_location location = std::source_location::current())
+        /// Run test case on calling thread, when buffered its output is kept in test case until reported.
+        void RunTest(CTestCase& testCase, const std::string& filter, const bool buffered)
         {
-            return CheckNotEqual(std::to_underlying(value), std::to_underlying(wanted), message, type, location);
+            Details::ActiveTest = &testCase;
+            Details::ActiveTrace = Details::CollectTrace ? &testCase.GetTrace() : nullptr;
+            LogBuffer* previous = buffered ? GetLog().SetCapture(&testCase.GetOutput()) : nullptr;
+            testCase.Run(filter);
+            if( buffered )
+            {
+                GetLog().SetCapture(previous);
+                testCase.MarkFinished();
+            }
+            Details::ActiveTest = nullptr;
+            Details::ActiveTrace = nullptr;
         }
 
-        template<class T, class U>
-        bool CheckNotEqual(const T& value, const U& wanted, const std::string& message, const EFailType type,
-            const std::source_location location = std::source_location::current())
+        std::pair<std::size_t, std::size_t> GetTestCount(const TestPlan& plan, const std::string& filter) const
         {
-            if( value != wanted )
+            std::size_t totalTests{0uz};
+            std::size_t filteredTests{0uz};
+            for(const auto& i: plan)
             {
-                return true;
+                totalTests += i.second.size();
+                for(const auto* j: i.second)
+                {
+                    if( j->IsRun(filter) )
+                    {
+                        ++filteredTests;
+                    }
+                }
             }
-            HandleFailure(std::format("Value '{}' should not be '{}'", message, wanted), type, location);
-            return false;
+            return {totalTests, filteredTests};
         }
 
-        template<IsPointerType T, IsPointerType U>
-        bool CheckPointer(const T& value, const U& wanted, const std::string& message, const EFailType type,
-            const std::source_location location = std::source_location::current())
+        void PrintSummary(const EConsoleColor color, const std::string& caption, const std::vector<CTestCase*>& array)
         {
-            if( value == wanted )
+            if( array.size() )
             {
-                return true;
+                GetLog().Write(color, "[Manager] {} tests: {}\n", caption, array.size());
             }
-            HandleFailure(std::format("Pointer '{}' should be {}", message, Details::FormatPointer(wanted)), type, location);
-            return false;
         }
+    private:
+        std::unordered_map<std::string, std::vector<std::unique_ptr<CTestCase>>> Tests{};
+        /// Sections in order of registration.
+        std::vector<std::string> Sections{};
+        /// Names of tests per section, used to find duplicates.
+        std::unordered_map<std::string, std::unordered_set<std::string>> TestNames{};
+        bool Collected{false};
+        BenchmarkOptions Benchmark{};
+        std::unordered_map<std::string, std::uint64_t> ExploreSeeds{};
+        /// Durations of test cases in milliseconds from timing cache, keyed by full name.
+        std::unordered_map<std::string, float> Timings{};
+        /// Results of test cases from result cache, keyed by GetResultKey.
+        std::unordered_map<std::string, ETestResult> Results{};
+    };
+    inline CTestManager& GetTestManager() { return CTestManager::Instance(); }
 
-        template<IsPointerType T, IsPointerType U>
-        bool CheckNotPointer(const T& value, const U& wanted, const std::string& message, const EFailType type,
-            const std::source_location location = std::source_location::current())
+    /// Shared fixture of active test case section or global shared fixture of given type.
+    template<std::derived_from<SharedFixture> T>
+    T& GetSharedFixture()
+    {
+        const CTestCase* testCase = GetTestManager().GetActiveTest();
+        for(auto& i: Details::GetSharedFixtures())
         {
-            if( value != wanted )
+            if( testCase && i.Fixture && Details::IsSharedFixtureOf(*i.Descriptor, testCase->GetSection()) )
             {
-                return true;
+                if( auto* fixture = dynamic_cast<T*>(i.Fixture.get()) )
+                {
+                    return *fixture;
+                }
             }
-            HandleFailure(std::format("Pointer '{}' should not be {}", message, Details::FormatPointer(wanted)), type, location);
-            return false;
+        }
+        throw std::logic_error("Shared fixture is not defined for section of this test case");
+    }
+
+    struct Registrar final
+    {
+        template<IsInvocable<void> Invocable>
+        Registrar(Invocable invocable)
+        {
+            invocable();
+        }
+
+        /// Link descriptor into registry, it does not allocate.
+        explicit Registrar(TestDescriptor& descriptor) noexcept
+        {
+            descriptor.Next = Details::RegisteredTests;
+            Details::RegisteredTests = &descriptor;
         }
 
-        bool CheckTrue(const bool result, const std::string& message, const EFailType type, const std::source_location location = std::source_location::current())
+        explicit Registrar(SharedFixtureDescriptor& descriptor) noexcept
         {
-            if( result )
+            descriptor.Next = Details::RegisteredSharedFixtures;
+            Details::RegisteredSharedFixtures = &descriptor;
+        }
+
+        explicit Registrar(DependencyDescriptor& descriptor) noexcept
+        {
+            descriptor.Next = Details::RegisteredDependencies;
+            Details::RegisteredDependencies = &descriptor;
+        }
+    };
+
+    /// Collect function of test case with single fixture.
+    template<std::derived_from<IFixtureWrapper> T>
+    void CollectTest(const TestDescriptor& descriptor)
+    {
+        GetTestManager().AddTest(descriptor.Section, descriptor.Name, descriptor.Location, []() -> FixtureWrapperPtr
+        {
+            return std::make_unique<T>();
+        });
+    }
+
+    /// Collect function of async test case, its body is coroutine.
+    template<std::derived_from<IFixtureWrapper> T>
+    void CollectAsyncTest(const TestDescriptor& descriptor)
+    {
+        CTestCase* testCase = GetTestManager().AddTest(descriptor.Section, descriptor.Name, descriptor.Location, []() -> FixtureWrapperPtr
+        {
+            return std::make_unique<T>();
+        });
+        if( testCase )
+        {
+            testCase->MarkAsync();
+        }
+    }
+
+    /// Collect function of table test, adds one test case per data row.
+    template<std::derived_from<IFixtureWrapper> T, typename Array>
+    void CollectTableTest(const TestDescriptor& descriptor, const Array& data)
+    {
+        const auto numCases = data.size();
+        GetTestManager().ReserveTests(descriptor.Section, numCases);
+        for(std::size_t i{0uz}; i < numCases; ++i)
+        {
+            // Fixture is made for name only when it overrides GenerateName, it is destroyed right after
+            std::string caseName = std::format("{}[{}]", descriptor.Name, Details::GenerateRowName<T>(data[i], i, nullptr));
+            GetTestManager().AddTest(descriptor.Section, caseName, descriptor.Location, [&row = data[i], i]() -> FixtureWrapperPtr
             {
-                return true;
-            }
-            HandleFailure(std::format("Expression '{}' should evaluate to true", message), type, location);
-            return false;
+                return std::make_unique<T>(row, i);
+            });
         }
+    }
 
-        bool CheckFalse(const bool result, const std::string& message, const EFailType type, const std::source_location location = std::source_location::current())
+    /// Collect function of generated table test, adds one test case per row. Row is made only when its test case runs, so case is named by index.
+    template<std::derived_from<IFixtureWrapper> T, IsTableGenerator Generator>
+    void CollectGeneratorTest(const TestDescriptor& descriptor, const Generator& generator)
+    {
+        const std::size_t numCases = std::size(generator);
+        GetTestManager().ReserveTests(descriptor.Section, numCases);
+        for(std::size_t i{0uz}; i < numCases; ++i)
         {
-            if( !result )
+            CTestCase* testCase = GetTestManager().AddTest(descriptor.Section, std::format("{}[{}]", descriptor.Name, i), descriptor.Location,
+                [&generator, i]() -> FixtureWrapperPtr
+                {
+                    if constexpr( std::ranges::random_access_range<const Generator> )
+                    {
+                        return std::make_unique<T>(std::ranges::begin(generator)[static_cast<std::ranges::range_difference_t<const Generator>>(i)], i);
+                    }
+                    else
+                    {
+                        return std::make_unique<T>(generator[i], i);
+                    }
+                });
+            if( testCase )
             {
-                return true;
+                testCase->MarkGeneratedRow();
             }
-            HandleFailure(std::format("Expression '{}' should evaluate to false", message), type, location);
-            return false;
         }
+    }
 
-        template<class T, class E>
-        bool CheckNear(const T& value, const T& wanted, const E& epsilon, const std::string& message, const EFailType type,
-            const std::source_location location = std::source_location::current())
+    namespace Details
+    {
+        /// Run benchmark body once with given iterations count, returns time per whole sample.
+        template<IsInvocable<void, CBenchmark&> Invocable>
+        std::optional<std::chrono::nanoseconds> RunBenchmarkSample(Invocable& body, const std::size_t iterations)
+        {
+            CBenchmark benchmark{iterations};
+            body(benchmark);
+            return benchmark.GetElapsed();
+        }
+
+        inline BenchmarkStats MakeBenchmarkStats(std::vector<double> samples, const std::size_t iterations)
         {
-            if( IsNear(value, wanted, epsilon) )
+            std::ranges::sort(samples);
+            const double count = static_cast<double>(samples.size());
+            BenchmarkStats stats{};
+            stats.Iterations = iterations;
+            stats.Samples = samples.size();
+            stats.Min = samples.front();
+            const std::size_t middle = samples.size() / 2uz;
+            stats.Median = samples.size() % 2uz == 0uz ? (samples[middle - 1uz] + samples[middle]) / 2.0 : samples[middle];
+            stats.Mean = std::accumulate(samples.begin(), samples.end(), 0.0) / count;
+            double variance{0.0};
+            for(const double i: samples)
             {
-                return true;
+                variance += (i - stats.Mean) * (i - stats.Mean);
             }
-            HandleFailure(std::format("Value '{}' is '{}' but should be '{}' with delta '{}'", message, value, wanted, epsilon), type, location);
-            return false;
+            stats.StdDev = samples.size() > 1uz ? std::sqrt(variance / (count - 1.0)) : 0.0;
+            // Nearest-rank percentile.
+            const auto rank = static_cast<std::size_t>(std::ceil(0.99 * count));
+            stats.P99 = samples[std::max(rank, 1uz) - 1uz];
+            return stats;
         }
+    }
 
-        template<class E, IsInvocable<void> Invocable>
-        bool CheckThrow(Invocable invocable, const std::string& message, const std::string& exception, const EFailType type,
-            const std::source_location location = std::source_location::current())
+    /// Run benchmark body: iterations count is calibrated so each sample takes its share of benchmark time,
+    /// then samples are measured and reported in nanoseconds per iteration.
+    template<IsInvocable<void, CBenchmark&> Invocable>
+    void RunBenchmark(Invocable body)
+    {
+        constexpr std::size_t MAX_ITERATIONS = 1'000'000'000uz;
+        const BenchmarkOptions& options = GetTestManager().GetBenchmarkOptions();
+        const std::chrono::nanoseconds sampleTime = options.MinTime / static_cast<std::int64_t>(options.Samples);
+        // Calibration, it also warms up caches.
+        std::size_t iterations{1uz};
+        while( true )
         {
-            try
+            const auto elapsed = Details::RunBenchmarkSample(body, iterations);
+            if( !elapsed )
             {
-                invocable();
-                HandleFailure(std::format("Expression '{}' should throw '{}' but none exception was thrown", message, exception), type, location);
-                return false;
+                GetTestManager().GetActiveTest()->Fail("Benchmark body must iterate over benchmark state", true);
+                return;
             }
-            catch(E&)
+            if( *elapsed >= sampleTime || iterations >= MAX_ITERATIONS )
             {
-                return true;
+                break;
             }
-            catch(...)
+            // Overshoot a bit so calibration ends quickly, but do not grow more than 10 times at once.
+            const double scale = elapsed->count() > 0 ?
+                std::clamp(1.4 * static_cast<double>(sampleTime.count()) / static_cast<double>(elapsed->count()), 2.0, 10.0) : 10.0;
+            iterations = std::min(static_cast<std::size_t>(static_cast<double>(iterations) * scale), MAX_ITERATIONS);
+        }
+        // Measure.
+        std::vector<double> samples{};
+        samples.reserve(options.Samples);
+        std::optional<PerfCounterStats> perfCounters{};
+        {
+            const Details::CPerfScope perf{perfCounters};
+            for(std::size_t i{0uz}; i < options.Samples; ++i)
             {
-                HandleFailure(std::format("Expression '{}' should throw '{}' but another exception was thrown", message, exception), type, location);
-                return false;
+                const auto elapsed = Details::RunBenchmarkSample(body, iterations);
+                samples.push_back(static_cast<double>(elapsed.value_or(std::chrono::nanoseconds{}).count()) / static_cast<double>(iterations));
             }
         }
+        const BenchmarkStats stats = Details::MakeBenchmarkStats(std::move(samples), iterations);
+        GetTestManager().GetActiveTest()->SetBenchmarkStats(stats);
+        GetLog().Write(EConsoleColor::Yellow, "[Bench  ] min {:.2f} ns, median {:.2f} ns, mean {:.2f} ns, stddev {:.2f} ns, p99 {:.2f} ns per iteration ({} x {} iterations)\n",
+            stats.Min, stats.Median, stats.Mean, stats.StdDev, stats.P99, stats.Samples, stats.Iterations);
+        if( perfCounters )
+        {
+            GetLog().Write(EConsoleColor::Yellow, "[Bench  ] {} per iteration\n",
+                Details::FormatPerfCounters(*perfCounters, static_cast<double>(stats.Samples * stats.Iterations)));
+        }
+    }
 
-        template<IsInvocable<void> Invocable>
-        bool CheckAnyThrow(Invocable invocable, const std::string& message, const EFailType type,
-            const std::source_location location = std::source_location::current())
+    namespace Details
+    {
+        /// Limit of MTEST_CONCURRENT run, zero duration means no time limit.
+        struct ConcurrentLimit
         {
-            try
+            std::uint64_t Iterations{std::numeric_limits<std::uint64_t>::max()}; // Per thread
+            std::chrono::nanoseconds Duration{0};
+        };
+
+        /// Pin calling thread to one of processors it is allowed to run on, so stress threads really run at the same time. Supported on Linux.
+        inline void PinThread(const std::size_t index)
+        {
+        #ifdef MTEST_LINUX_PLATFORM
+            cpu_set_t allowed{};
+            CPU_ZERO(&allowed);
+            const int processors = sched_getaffinity(0, sizeof(allowed), &allowed) == 0 ? CPU_COUNT(&allowed) : 0;
+            if( processors <= 0 )
             {
-                invocable();
-                HandleFailure(std::format("Expression '{}' should throw exception", message), type, location);
-                return false;
+                return;
             }
-            catch(...)
+            // Processors are picked from affinity mask, so restricted cpuset (eg. container) is respected.
+            std::size_t remaining = index % static_cast<std::size_t>(processors);
+            for(std::size_t i{0uz}; i < std::size_t{CPU_SETSIZE}; ++i)
             {
-                return true;
+                if( !CPU_ISSET(i, &allowed) || remaining-- > 0uz )
+                {
+                    continue;
+                }
+                cpu_set_t set{};
+                CPU_ZERO(&set);
+                CPU_SET(i, &set);
+                // Pinning is only a hint, run is correct without it.
+                std::ignore = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+                return;
             }
+        #else
+            std::ignore = index;
+        #endif
         }
 
-        template<IsInvocable<void> Invocable>
-        bool CheckNoThrow(Invocable invocable, const std::string& message, const EFailType type,
-            const std::source_location location = std::source_location::current())
+        template<std::invocable<std::size_t> Invocable>
+        ConcurrentStats RunConcurrent(std::size_t threads, const ConcurrentLimit limit, Invocable& body)
         {
+            using ConcurrentClock = std::chrono::steady_clock;
+            CTestCase* owner = ActiveTest;
+            if( !owner )
+            {
+                throw std::logic_error("MTEST_CONCURRENT must be used inside test case");
+            }
+            if( threads == 0uz )
+            {
+                threads = std::max(std::thread::hardware_concurrency(), 1u);
+            }
+            ConcurrentStats stats{};
+            stats.Threads = threads;
+            stats.ThreadOperations.resize(threads);
+            std::vector<LogBuffer> outputs(threads);
+            // Time is measured by threads, waking of calling thread can be late.
+            std::vector<std::pair<ConcurrentClock::time_point, ConcurrentClock::time_point>> times(threads);
+            std::latch start{static_cast<std::ptrdiff_t>(threads + 1uz)};
+            std::atomic<bool> stop{false};
+            std::mutex errorMutex{};
+            std::exception_ptr error{};
+            std::size_t errorThread{0uz};
+            std::vector<std::thread> workers{};
+            // Threads release their state themselves, allocations are counted per thread so body allocations are not counted at all.
+            const CAllocationPause pause{};
+            workers.reserve(threads);
             try
             {
-                invocable();
-                return true;
+                for(std::size_t i{0uz}; i < threads; ++i)
+                {
+                    workers.emplace_back([&, i]()
+                    {
+                        const CAllocationPause workerPause{};
+                        ActiveTest = owner;
+                        ActiveThread = i;
+                        GetLog().SetCapture(&outputs[i]);
+                        PinThread(i);
+                        start.arrive_and_wait();
+                        times[i].first = ConcurrentClock::now();
+                        std::uint64_t operations{0u};
+                        try
+                        {
+                            while( operations < limit.Iterations && !stop.load(std::memory_order_relaxed) )
+                            {
+                                body(i);
+                                ++operations;
+                            }
+                        }
+                        catch(...)
+                        {
+                            // First error stops all threads, like assertion stops test case.
+                            const std::lock_guard lock{errorMutex};
+                            if( !error )
+                            {
+                                error = std::current_exception();
+                                errorThread = i;
+                            }
+                            stop.store(true, std::memory_order_relaxed);
+                        }
+                        times[i].second = ConcurrentClock::now();
+                        stats.ThreadOperations[i] = operations;
+                        GetLog().SetCapture(nullptr);
+                        ActiveThread = NO_THREAD;
+                        ActiveTest = nullptr;
+                    });
+                }
             }
             catch(...)
             {
-                HandleFailure(std::format("Expression '{}' should not throw exception", message), type, location);
-                return false;
+                // Started threads are released for threads which were not created and calling thread, they stop without running body.
+                stop.store(true, std::memory_order_relaxed);
+                start.count_down(static_cast<std::ptrdiff_t>(threads - workers.size() + 1uz));
+                for(auto& i: workers)
+                {
+                    i.join();
+                }
+                throw;
+            }
+            start.arrive_and_wait();
+            if( limit.Duration > std::chrono::nanoseconds{0} )
+            {
+                // Threads which are stopped by error wake nobody, so sleep is cut to small steps.
+                const auto end = ConcurrentClock::now() + limit.Duration;
+                while( !stop.load(std::memory_order_relaxed) && ConcurrentClock::now() < end )
+                {
+                    std::this_thread::sleep_for(std::min<std::chrono::nanoseconds>(end - ConcurrentClock::now(), std::chrono::milliseconds{10}));
+                }
+                stop.store(true, std::memory_order_relaxed);
+            }
+            for(auto& i: workers)
+            {
+                i.join();
+            }
+            const auto begin = std::ranges::min(times, {}, [](const auto& i) { return i.first; }).first;
+            const auto end = std::ranges::max(times, {}, [](const auto& i) { return i.second; }).second;
+            stats.Duration = std::chrono::duration<double>(end - begin).count();
+            // Output of threads is written in order of threads, so it is not interleaved.
+            for(auto& i: outputs)
+            {
+                GetLog().Write(std::move(i));
+            }
+            if( error )
+            {
+                try
+                {
+                    std::rethrow_exception(error);
+                }
+                catch(const CTestAssertionException&)
+                {
+                    throw;
+                }
+                catch(const CTestSkippedException&)
+                {
+                    throw;
+                }
+                catch(const std::exception& e)
+                {
+                    throw std::runtime_error(std::format("[Thread {}] {}", errorThread, e.what()));
+                }
+                catch(...)
+                {
+                    throw std::runtime_error(std::format("[Thread {}] Unknown exception was thrown", errorThread));
+                }
             }
+            stats.Operations = std::accumulate(stats.ThreadOperations.begin(), stats.ThreadOperations.end(), std::uint64_t{0u});
+            stats.OperationsPerSecond = stats.Duration > 0.0 ? static_cast<double>(stats.Operations) / stats.Duration : 0.0;
+            const auto [fewest, most] = std::ranges::minmax(stats.ThreadOperations);
+            GetLog().Write(EConsoleColor::Yellow, "[Stress ] {} threads, {} operations {}, {:.0f} operations per second, {} to {} per thread\n",
+                stats.Threads, stats.Operations, FormatTime(static_cast<float>(stats.Duration * 1000.0)), stats.OperationsPerSecond,
+                fewest, most);
+            return stats;
         }
+    }
 
-        bool CheckCustom(const CheckResult& result, const EFailType type, const std::source_location location = std::source_location::current())
+    /// Run body on threads which are released together, each thread calls it given number of times. See MTEST_CONCURRENT.
+    template<std::invocable<std::size_t> Invocable>
+    ConcurrentStats RunConcurrent(const std::size_t threads, const std::uint64_t iterations, Invocable body)
+    {
+        return Details::RunConcurrent(threads, Details::ConcurrentLimit{iterations, {}}, body);
+    }
+
+    /// Run body on threads which are released together, each thread calls it until time is up. See MTEST_CONCURRENT.
+    template<class Rep, class Period, std::invocable<std::size_t> Invocable>
+    ConcurrentStats RunConcurrent(const std::size_t threads, const std::chrono::duration<Rep, Period> duration, Invocable body)
+    {
+        return Details::RunConcurrent(threads, Details::ConcurrentLimit{std::numeric_limits<std::uint64_t>::max(), std::chrono::duration_cast<std::chrono::nanoseconds>(duration)}, body);
+    }
+
+    /// How MTEST_EXPLORE chooses thread which runs at each scheduling point.
+    enum class EExploreStrategy
+    {
+        Random, // Any ready thread
+        PCT // Ready thread with highest random priority, priority of running thread is lowered at Depth-1 random points
+    };
+
+    /// Options of MTEST_EXPLORE.
+    struct ExploreOptions
+    {
+        std::size_t Schedules{1000uz};
+        EExploreStrategy Strategy{EExploreStrategy::Random};
+        std::size_t Depth{3uz}; // PCT: finds bugs which need up to Depth ordering constraints
+        std::size_t Steps{64uz}; // PCT: expected scheduling points per schedule, priority change points are spread over them
+        std::size_t MaxSteps{100'000uz}; // Schedule which does not finish in that many scheduling points fails, eg. livelock
+        std::uint64_t Seed{0u}; // Seeds of schedules are derived from it
+    };
+
+    /// Result of MTEST_EXPLORE.
+    struct ExploreStats
+    {
+        std::size_t Schedules{0uz};
+        std::size_t Points{0uz}; // Scheduling points of all schedules
+        std::optional<std::uint64_t> FailedSeed{}; // Seed of first failed schedule
+    };
+
+    class CInterleaving;
+
+    namespace Details
+    {
+        /// Interleaving which controls calling thread, null outside of MTEST_EXPLORE threads.
+        constinit inline thread_local CInterleaving* ActiveInterleaving{nullptr};
+
+        /// Thrown in controlled threads when schedule is aborted, so they unwind to their end.
+        struct ExploreAbort {};
+    }
+
+    /// Runs threads of MTEST_EXPLORE one at a time, they switch only at scheduling points: operations of MTest::atomic and MTest::mutex.
+    /// Which thread runs next is decided by seeded strategy, so each schedule can be replayed by its seed.
+    /// Threads are created once and reused by all schedules.
+    class CInterleaving final
+    {
+        enum class EThreadState
+        {
+            Ready,
+            Blocked,
+            Done
+        };
+
+        struct Worker
+        {
+            std::thread Thread{};
+            std::binary_semaphore Wake{0};
+            std::function<void()> Body{};
+            EThreadState State{EThreadState::Done};
+            const void* WaitsFor{};
+            std::size_t Priority{0uz};
+        };
+    public:
+        CInterleaving(const ExploreOptions& options, CTestCase* owner):
+            Options(options),
+            Owner(owner),
+            Capture(GetLog().SetCapture(nullptr))
+        {
+            GetLog().SetCapture(Capture);
+        }
+        CInterleaving(const CInterleaving&) = delete;
+        CInterleaving(CInterleaving&&) = delete;
+        ~CInterleaving()
         {
-            if( !result.has_value() )
+            Exiting = true;
+            for(auto& i: Workers)
             {
-                return true;
+                i->Wake.release();
+                i->Thread.join();
             }
-            HandleFailure(result.value(), type, location);
-            return false;
         }
 
-        void Fail(const std::string& reason, bool stop, const std::source_location location = std::source_location::current())
+        CInterleaving& operator=(const CInterleaving&) = delete;
+        CInterleaving& operator=(CInterleaving&&) = delete;
+
+        /// Run given functions as threads of current schedule, returns when all of them are finished.
+        /// Failed assertion or exception in any thread aborts schedule and is rethrown.
+        template<std::invocable...Invocables>
+        void Run(Invocables&&...bodies)
         {
-            HandleFailure(reason, stop ? EFailType::Assert : EFailType::Check, location);
+            std::vector<std::function<void()>> threads{};
+            (threads.emplace_back(std::forward<Invocables>(bodies)), ...);
+            RunThreads(std::move(threads));
         }
 
-        void Skip(const std::string& reason)
+        /// Seed of current schedule.
+        std::uint64_t GetSeed() const { return Seed; }
+        /// Scheduling points reached in current schedule.
+        std::size_t GetPoints() const { return Points; }
+
+        /// Start new schedule, threads run by it are chosen by given seed.
+        void Begin(const std::uint64_t seed)
         {
-            MarkSkipped();
-            GetLog().Write(EConsoleColor::Magenta, "[Skipped] {}\n", reason);
-            throw CTestSkippedException{};
+            Seed = seed;
+            Random = Details::CRandom{seed};
+            Points = 0uz;
+            NextChange = 0uz;
+            ChangePoints.clear();
+            if( Options.Strategy == EExploreStrategy::PCT )
+            {
+                for(std::size_t i{1uz}; i < Options.Depth; ++i)
+                {
+                    ChangePoints.push_back(Random.Below(std::max(Options.Steps, 1uz)) + 1uz);
+                }
+                std::ranges::sort(ChangePoints);
+            }
         }
 
-        void PrintResult(const bool isCompact) const
+        /// Scheduling point of running thread, other thread can run before it continues.
+        void Point()
         {
-            if( isCompact )
+            if( std::uncaught_exceptions() > 0 )
             {
-                GetLog().Write(Details::TestResultToColor(Result), "{} {} {}\n", Details::TestResultToString(Result),
-                    GetFullname(), Details::FormatTime(Duration));
+                // Thread unwinds from aborted schedule, it is not switched anymore.
+                return;
             }
-            else
+            if( Aborting )
             {
-                GetLog().Write(Details::TestResultToColor(Result), "{} {} in File: {}, Line: {}\n", Details::TestResultToString(Result),
-                    GetFullname(), GetFile(), GetLine());
+                throw Details::ExploreAbort{};
+            }
+            if( ++Points > Options.MaxSteps )
+            {
+                throw std::runtime_error(std::format("Schedule did not finish in {} scheduling points, threads may livelock", Options.MaxSteps));
+            }
+            while( NextChange < ChangePoints.size() && ChangePoints[NextChange] == Points )
+            {
+                // Lower than all initial priorities, later changes go even lower.
+                Workers[Current]->Priority = Options.Depth - 1uz - NextChange;
+                ++NextChange;
             }
+            SwitchTo(Pick());
         }
-    private:
-        void MarkFailed() { Result = ETestResult::Fail; }
-        void MarkSkipped() { Result = ETestResult::Skip; }
 
-        void HandleFailure(const std::string& message, const EFailType type, const std::source_location location)
+        /// Running thread waits until object is released, eg. locked mutex.
+        void Block(const void* object)
         {
-            MarkFailed();
-            GetLog().Write(EConsoleColor::Red, "{} {} in File: {}, Line: {}\n", Details::FailTypeToString(type), message,
-                Details::FilenameFromPath(location.file_name()), location.line());
-            if( type == EFailType::Assert )
+            Worker& self = *Workers[Current];
+            self.State = EThreadState::Blocked;
+            self.WaitsFor = object;
+            const std::size_t next = Pick();
+            if( next == NO_WORKER )
             {
-                throw CTestAssertionException{};
+                self.State = EThreadState::Ready;
+                throw std::runtime_error("Deadlock, all threads wait for mutex");
+            }
+            SwitchTo(next);
+            if( Aborting && std::uncaught_exceptions() == 0 )
+            {
+                throw Details::ExploreAbort{};
             }
         }
 
-        void HandleException(const std::string& what)
+        /// Threads which wait for object can run again.
+        void Release(const void* object)
         {
-            MarkFailed();
-            GetLog().Write(EConsoleColor::Red, "[Fatal  ] {}\n", what);
+            for(std::size_t i{0uz}; i < Count; ++i)
+            {
+                if( Workers[i]->State == EThreadState::Blocked && Workers[i]->WaitsFor == object )
+                {
+                    Workers[i]->State = EThreadState::Ready;
+                    Workers[i]->WaitsFor = nullptr;
+                }
+            }
         }
+    private:
+        static constexpr std::size_t NO_WORKER = std::numeric_limits<std::size_t>::max();
 
-        template<IsInvocable<void> Invocable>
-        void Runner(Invocable invocable)
+        void RunThreads(std::vector<std::function<void()>> threads)
         {
-            try
+            if( Details::ActiveInterleaving )
             {
-                invocable();
+                throw std::logic_error("CInterleaving::Run can not be called from explored thread");
             }
-            catch(const CTestAssertionException&) {}
-            catch(const CTestSkippedException&) {}
-            catch(const std::exception& e)
+            if( threads.empty() )
             {
-                HandleException(e.what());
+                return;
             }
-            catch(...)
             {
-                HandleException("Unknown exception was thrown");
+                // Threads release their state themselves, so it is not counted by test case.
+                const Details::CAllocationPause pause{};
+                while( Workers.size() < threads.size() )
+                {
+                    auto& worker = Workers.emplace_back(std::make_unique<Worker>());
+                    worker->Thread = std::thread([this, &self = *worker, index = Workers.size() - 1uz]() { WorkerLoop(self, index); });
+                }
+            }
+            Count = threads.size();
+            std::vector<std::size_t> priorities(Count);
+            std::iota(priorities.begin(), priorities.end(), Options.Depth);
+            Random.Shuffle(priorities);
+            for(std::size_t i{0uz}; i < Count; ++i)
+            {
+                Workers[i]->Body = std::move(threads[i]);
+                Workers[i]->State = EThreadState::Ready;
+                Workers[i]->WaitsFor = nullptr;
+                Workers[i]->Priority = priorities[i];
+            }
+            Aborting = false;
+            Error = nullptr;
+            Current = Pick();
+            Workers[Current]->Wake.release();
+            Finished.acquire();
+            for(std::size_t i{0uz}; i < Count; ++i)
+            {
+                Workers[i]->Body = nullptr;
+            }
+            if( Error )
+            {
+                try
+                {
+                    std::rethrow_exception(std::exchange(Error, nullptr));
+                }
+                catch(const CTestAssertionException&)
+                {
+                    throw;
+                }
+                catch(const CTestSkippedException&)
+                {
+                    throw;
+                }
+                catch(const std::exception& e)
+                {
+                    throw std::runtime_error(std::format("[Thread {}] {}", ErrorThread, e.what()));
+                }
+                catch(...)
+                {
+                    throw std::runtime_error(std::format("[Thread {}] Unknown exception was thrown", ErrorThread));
+                }
             }
         }
-    private:
-        std::string Section{};
-        std::string Name{};
-        std::string Fullname{};
-        std::string File{};
-        std::uint_least32_t Line{};
-        ETestResult Result{ETestResult::Success};
-        FixtureWrapperPtr Fixture{};
-        float Duration{0.0f}; // In miliseconds
-    };
-
-    /// Manages tests and runs them
-    class CTestManager final
-    {
-    private:
-        CTestManager() = default;
-    public:
-        CTestManager(const CTestManager&) = delete;
-        CTestManager(CTestManager&&) = delete;
-        ~CTestManager() = default;
 
-        CTestManager& operator=(const CTestManager&) = delete;
-        CTestManager& operator=(CTestManager&&) = delete;
-
-        static CTestManager& Instance()
+        /// Worker is given directly, as list of workers can grow while thread starts.
+        void WorkerLoop(Worker& self, const std::size_t index)
         {
-            static CTestManager manager;
-            return manager;
+            const Details::CAllocationPause pause{};
+            Details::ActiveTest = Owner;
+            Details::ActiveThread = index;
+            Details::ActiveInterleaving = this;
+            // Only one thread runs at a time, so output goes directly to output of test case.
+            GetLog().SetCapture(Capture);
+            while( true )
+            {
+                self.Wake.acquire();
+                if( Exiting )
+                {
+                    break;
+                }
+                try
+                {
+                    self.Body();
+                }
+                catch(const Details::ExploreAbort&) {}
+                catch(...)
+                {
+                    if( !Error )
+                    {
+                        Error = std::current_exception();
+                        ErrorThread = index;
+                    }
+                    Aborting = true;
+                }
+                self.State = EThreadState::Done;
+                Leave();
+            }
+            GetLog().SetCapture(nullptr);
+            Details::ActiveInterleaving = nullptr;
+            Details::ActiveThread = Details::NO_THREAD;
+            Details::ActiveTest = nullptr;
         }
 
-        CTestCase* GetActiveTest() const { return ActiveTest; }
-
-        void AddTest(const std::string& section, const std::string& name, const std::source_location location, FixtureWrapperPtr fixture)
+        /// Running thread has finished, next thread runs or schedule ends.
+        void Leave()
         {
-            auto& sectionTests = Tests[section];
-            auto it = std::find_if(sectionTests.begin(), sectionTests.end(), [&](const std::unique_ptr<CTestCase>& other)
+            std::size_t next = Pick();
+            if( next == NO_WORKER && !Aborting &&
+                std::ranges::any_of(Workers | std::views::take(Count), [](const auto& i) { return i->State == EThreadState::Blocked; }) )
             {
-                return other->GetName() == name;
-            });
-            if( it != sectionTests.end() )
+                Error = std::make_exception_ptr(std::runtime_error("Deadlock, all threads wait for mutex"));
+                ErrorThread = Current;
+                Aborting = true;
+                next = Pick();
+            }
+            if( next == NO_WORKER )
             {
-                GetLog().Write(EConsoleColor::Red, "[Error  ] {} already exists\n", CTestCase::MakeFullname(section, name));
+                Finished.release();
                 return;
             }
-            sectionTests.push_back(std::make_unique<CTestCase>(section, name, location, std::move(fixture)));
+            Current = next;
+            Workers[next]->Wake.release();
         }
 
-        bool Run(int argc, const char* const argv[])
+        void SwitchTo(const std::size_t next)
         {
-            std::vector<std::string> cmd{};
-            for(int i{1}; i < argc; ++i)
+            const std::size_t self = Current;
+            if( next == self )
             {
-                cmd.push_back(argv[i]);
+                return;
             }
-            return Run(cmd);
+            Current = next;
+            Workers[next]->Wake.release();
+            Workers[self]->Wake.acquire();
         }
 
-        bool Run(const std::vector<std::string>& cmd)
+        /// Thread which runs next, blocked threads can run only to unwind aborted schedule.
+        std::size_t Pick()
         {
-            std::string filter{};
-            for(const auto& i: cmd)
+            Ready.clear();
+            for(std::size_t i{0uz}; i < Count; ++i)
             {
-                if( i.starts_with("-F=") || i.starts_with("--Filter=") )
-                {
-                    filter = i.substr(i.find_first_of('=') + 1uz);
-                }
-                else
+                const auto state = Workers[i]->State;
+                if( state == EThreadState::Ready || (Aborting && state == EThreadState::Blocked) )
                 {
-                    GetLog().Write(EConsoleColor::Red, "[Manager] Invalid argument: {}\n", i);
-                    return false;
+                    Ready.push_back(i);
                 }
             }
-            const auto [totalTestsCount, filteredTestsCount] = GetTestCount(filter);
-            if(filteredTestsCount != totalTestsCount)
+            if( Ready.empty() )
             {
-                GetLog().Write(EConsoleColor::Blue, "[Manager] Running {} from {} tests\n", filteredTestsCount, totalTestsCount);
+                return NO_WORKER;
             }
-            else
+            if( Aborting )
             {
-                GetLog().Write(EConsoleColor::Blue, "[Manager] Running {} tests\n", totalTestsCount);
+                return Ready.front();
             }
-            if( !filter.empty() )
+            if( Options.Strategy == EExploreStrategy::PCT )
             {
-                GetLog().Write(EConsoleColor::Blue, "[Manager] Test filter: '{}'\n", filter);
+                return *std::ranges::max_element(Ready, {}, [&](const std::size_t i) { return Workers[i]->Priority; });
             }
-            GetLog().Write("\n");
-            // Run tests now.
-            float totalTime{0.0f};
-            std::vector<CTestCase*> failedTests{};
-            std::vector<CTestCase*> skippedTests{};
-            std::vector<CTestCase*> successfulTests{};
-            for(const auto& i: Tests)
+            return Ready[Random.Below(Ready.size())];
+        }
+    private:
+        ExploreOptions Options{};
+        CTestCase* Owner{};
+        LogBuffer* Capture{};
+        std::vector<std::unique_ptr<Worker>> Workers{};
+        std::binary_semaphore Finished{0};
+        // State below is used only by running thread, threads are switched by semaphores.
+        bool Exiting{false};
+        std::size_t Count{0uz};
+        std::size_t Current{0uz};
+        std::vector<std::size_t> Ready{};
+        std::uint64_t Seed{0u};
+        Details::CRandom Random{0u};
+        std::size_t Points{0uz};
+        std::vector<std::size_t> ChangePoints{};
+        std::size_t NextChange{0uz};
+        bool Aborting{false};
+        std::exception_ptr Error{};
+        std::size_t ErrorThread{0uz};
+    };
+
+    /// Mutex which is scheduling point of MTEST_EXPLORE threads, elsewhere it is std::mutex.
+    class mutex final
+    {
+    public:
+        mutex() = default;
+        mutex(const mutex&) = delete;
+        mutex(mutex&&) = delete;
+        ~mutex() = default;
+
+        mutex& operator=(const mutex&) = delete;
+        mutex& operator=(mutex&&) = delete;
+
+        void lock()
+        {
+            if( auto* interleaving = Details::ActiveInterleaving )
             {
-                float sectionTime{0.0f};
-                GetLog().Write(EConsoleColor::Blue, "[-------] Running section {} which has {} tests\n", i.first, i.second.size());
-                for(const auto& j: i.second)
+                interleaving->Point();
+                while( Owner != Details::NO_THREAD )
                 {
-                    auto testCase = j.get();
-                    ActiveTest = testCase;
-                    testCase->Run(filter);
-                    ActiveTest = nullptr;
-                    // Update result.
-                    sectionTime += testCase->GetDuration();
-                    if( testCase->IsFailed() )
-                    {
-                        failedTests.push_back(testCase);
-                    }
-                    else if( testCase->IsSkipped() )
-                    {
-                        skippedTests.push_back(testCase);
-                    }
-                    else
-                    {
-                        successfulTests.push_back(testCase);
-                    }
+                    interleaving->Block(this);
                 }
-                GetLog().Write(EConsoleColor::Blue, "[-------] Section {} finished {}\n\n", i.first, Details::FormatTime(sectionTime));
-                totalTime += sectionTime;
+                Owner = Details::ActiveThread;
+                return;
             }
-            // Print result
-            GetLog().Write(EConsoleColor::Blue, "[Manager] Running finished {}\n", Details::FormatTime(totalTime));
-            if( totalTestsCount != 0uz )
+            Mutex.lock();
+        }
+
+        bool try_lock()
+        {
+            if( auto* interleaving = Details::ActiveInterleaving )
             {
-                // Print failed tests for quick lookup.
-                if( !failedTests.empty() )
+                interleaving->Point();
+                if( Owner != Details::NO_THREAD )
                 {
-                    GetLog().Write(EConsoleColor::Red, "[Manager] Failed test list:\n");
-                    for(const auto* i: failedTests)
-                    {
-                        i->PrintResult(false);
-                    }
+                    return false;
                 }
-                GetLog().Write(EConsoleColor::Blue, "[Manager] Test summary:\n");
-                PrintSummary(EConsoleColor::Green, "Successful", successfulTests);
-                PrintSummary(EConsoleColor::Red, "Failed", failedTests);
-                PrintSummary(EConsoleColor::Magenta, "Skipped", skippedTests);
+                Owner = Details::ActiveThread;
+                return true;
             }
-            else
+            return Mutex.try_lock();
+        }
+
+        void unlock()
+        {
+            if( auto* interleaving = Details::ActiveInterleaving )
             {
-                GetLog().Write(EConsoleColor::Blue, "[Manager] No tests are present\n");
+                Owner = Details::NO_THREAD;
+                interleaving->Release(this);
+                return;
             }
-            Tests.clear();
-            // Return
-            return failedTests.empty();
+            Mutex.unlock();
         }
     private:
-        std::pair<std::size_t, std::size_t> GetTestCount(const std::string& filter) const
+        std::mutex Mutex{};
+        std::size_t Owner{Details::NO_THREAD}; // Thread of MTEST_EXPLORE which holds mutex
+    };
+
+    /// Atomic which is scheduling point of MTEST_EXPLORE threads, elsewhere it is std::atomic. Threads of MTEST_EXPLORE run one at a time,
+    /// so only sequentially consistent executions are explored.
+    template<class T>
+    class atomic final
+    {
+    public:
+        atomic() noexcept = default;
+        constexpr atomic(const T value) noexcept:
+            Value(value)
         {
-            std::size_t totalTests{0uz};
-            std::size_t filteredTests{0uz};
-            for(const auto& i: Tests)
-            {
-                totalTests += i.second.size();
-                for(const auto& j: i.second)
-                {
-                    if( j->IsRun(filter) )
-                    {
-                        ++filteredTests;
-                    }
-                }
-            }
-            return {totalTests, filteredTests};
         }
+        atomic(const atomic&) = delete;
+        atomic(atomic&&) = delete;
+        ~atomic() = default;
 
-        void PrintSummary(const EConsoleColor color, const std::string& caption, const std::vector<CTestCase*>& array)
+        atomic& operator=(const atomic&) = delete;
+        atomic& operator=(atomic&&) = delete;
+
+        T operator=(const T value) { store(value); return value; }
+        operator T() const { return load(); }
+
+        bool is_lock_free() const noexcept { return Value.is_lock_free(); }
+
+        T load(const std::memory_order order = std::memory_order_seq_cst) const
         {
-            if( array.size() )
+            Point();
+            return Value.load(order);
+        }
+
+        void store(const T value, const std::memory_order order = std::memory_order_seq_cst)
+        {
+            Point();
+            Value.store(value, order);
+        }
+
+        T exchange(const T value, const std::memory_order order = std::memory_order_seq_cst)
+        {
+            Point();
+            return Value.exchange(value, order);
+        }
+
+        bool compare_exchange_weak(T& expected, const T desired, const std::memory_order order = std::memory_order_seq_cst)
+        {
+            Point();
+            return Value.compare_exchange_weak(expected, desired, order);
+        }
+
+        bool compare_exchange_weak(T& expected, const T desired, const std::memory_order success, const std::memory_order failure)
+        {
+            Point();
+            return Value.compare_exchange_weak(expected, desired, success, failure);
+        }
+
+        bool compare_exchange_strong(T& expected, const T desired, const std::memory_order order = std::memory_order_seq_cst)
+        {
+            Point();
+            return Value.compare_exchange_strong(expected, desired, order);
+        }
+
+        bool compare_exchange_strong(T& expected, const T desired, const std::memory_order success, const std::memory_order failure)
+        {
+            Point();
+            return Value.compare_exchange_strong(expected, desired, success, failure);
+        }
+
+        template<class U = T> requires requires(std::atomic<U>& value) { value.fetch_add(1); }
+        T fetch_add(const typename std::atomic<U>::difference_type arg, const std::memory_order order = std::memory_order_seq_cst)
+        {
+            Point();
+            return Value.fetch_add(arg, order);
+        }
+
+        template<class U = T> requires requires(std::atomic<U>& value) { value.fetch_sub(1); }
+        T fetch_sub(const typename std::atomic<U>::difference_type arg, const std::memory_order order = std::memory_order_seq_cst)
+        {
+            Point();
+            return Value.fetch_sub(arg, order);
+        }
+
+        template<class U = T> requires std::integral<U>
+        T fetch_and(const T arg, const std::memory_order order = std::memory_order_seq_cst)
+        {
+            Point();
+            return Value.fetch_and(arg, order);
+        }
+
+        template<class U = T> requires std::integral<U>
+        T fetch_or(const T arg, const std::memory_order order = std::memory_order_seq_cst)
+        {
+            Point();
+            return Value.fetch_or(arg, order);
+        }
+
+        template<class U = T> requires std::integral<U>
+        T fetch_xor(const T arg, const std::memory_order order = std::memory_order_seq_cst)
+        {
+            Point();
+            return Value.fetch_xor(arg, order);
+        }
+
+        template<class U = T> requires requires(std::atomic<U>& value) { value.fetch_add(1); }
+        T operator++() { return fetch_add(1) + 1; }
+        template<class U = T> requires requires(std::atomic<U>& value) { value.fetch_add(1); }
+        T operator++(int) { return fetch_add(1); }
+        template<class U = T> requires requires(std::atomic<U>& value) { value.fetch_sub(1); }
+        T operator--() { return fetch_sub(1) - 1; }
+        template<class U = T> requires requires(std::atomic<U>& value) { value.fetch_sub(1); }
+        T operator--(int) { return fetch_sub(1); }
+        template<class U = T> requires requires(std::atomic<U>& value) { value.fetch_add(1); }
+        T operator+=(const typename std::atomic<U>::difference_type arg) { return fetch_add(arg) + arg; }
+        template<class U = T> requires requires(std::atomic<U>& value) { value.fetch_sub(1); }
+        T operator-=(const typename std::atomic<U>::difference_type arg) { return fetch_sub(arg) - arg; }
+    private:
+        static void Point()
+        {
+            if( auto* interleaving = Details::ActiveInterleaving )
             {
-                GetLog().Write(color, "[Manager] {} tests: {}\n", caption, array.size());
+                interleaving->Point();
             }
         }
     private:
-        std::unordered_map<std::string, std::vector<std::unique_ptr<CTestCase>>> Tests{};
-        CTestCase* ActiveTest{};
+        std::atomic<T> Value{};
     };
-    inline CTestManager& GetTestManager() { return CTestManager::Instance(); }
 
-    struct Registrar final
+    /// Run body once per schedule, body creates fresh state and runs threads with CInterleaving::Run. Fixture is set up only once.
+    /// Exploration stops at first schedule which fails, its seed is reported so it can be replayed with --explore-seed=Section.Test:Seed.
+    template<std::invocable<CInterleaving&> Invocable>
+    ExploreStats Explore(const ExploreOptions& options, Invocable body)
     {
-        template<IsInvocable<void> Invocable>
-        Registrar(Invocable invocable)
+        using ExploreClock = std::chrono::steady_clock;
+        CTestCase* owner = Details::ActiveTest;
+        if( !owner )
         {
-            invocable();
+            throw std::logic_error("MTEST_EXPLORE must be used inside test case");
         }
-    };
+        const auto replay = GetTestManager().GetExploreSeed(owner->GetFullname());
+        const std::size_t schedules = replay ? 1uz : options.Schedules;
+        const auto start = ExploreClock::now();
+        CInterleaving interleaving{options, owner};
+        ExploreStats stats{};
+        const auto report = [&](const std::size_t schedule, const std::uint64_t seed)
+        {
+            GetLog().Write(EConsoleColor::Red, "[Explore] {}: schedule {} failed after {} scheduling points, replay it with --Filter={} --explore-seed={}:{}\n",
+                owner->GetFullname(), schedule + 1uz, interleaving.GetPoints(), owner->GetFullname(), owner->GetFullname(), seed);
+        };
+        for(std::size_t i{0uz}; i < schedules; ++i)
+        {
+            const std::uint64_t seed = replay ? *replay : Details::CRandom{options.Seed + i}.Next();
+            const std::size_t failures = owner->GetFailures().size();
+            interleaving.Begin(seed);
+            ++stats.Schedules;
+            try
+            {
+                body(interleaving);
+            }
+            catch(...)
+            {
+                report(i, seed);
+                throw;
+            }
+            stats.Points += interleaving.GetPoints();
+            if( owner->GetFailures().size() != failures )
+            {
+                stats.FailedSeed = seed;
+                report(i, seed);
+                break;
+            }
+        }
+        const float time = std::chrono::duration<float, std::milli>(ExploreClock::now() - start).count();
+        GetLog().Write(EConsoleColor::Yellow, "[Explore] {} schedules ({}), {} scheduling points {}, {:.0f} schedules per second\n",
+            stats.Schedules, options.Strategy == EExploreStrategy::PCT ? "PCT" : "random", stats.Points, Details::FormatTime(time),
+            time > 0.0f ? static_cast<float>(stats.Schedules) * 1000.0f / time : 0.0f);
+        return stats;
+    }
 }